@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <memory.h>
 
 //-------------------------------------------------------------------------------------------------
@@ -40,7 +41,12 @@
 // - What's different here?
 //   - pure C implementation
 //   - all memory management occur during startup, no allocation/deallocation on the heap after that
-//   - use of global variables to reduce stack initialization on function calls
+//   - all of the state of a search is kept in a context (Context_t), one per worker
+//     - the functions only ever touch the context they're handed, so several workers (each
+//       with its own context) can search for P(N) of different bases at the same time
+//     - each context, registers and all, is a single cache line aligned block of memory,
+//       so the workers never share a cache line
+//     - the sizes of the registers are chosen when the context is created
 //
 // - Notation
 //   - Digit_t  = a single digit within an arbitrary base number
@@ -50,6 +56,8 @@
 //   - Binary_t = a struct containing a length (number of bits) and an array of bits
 //-------------------------------------------------------------------------------------------------
 
+// Register sizes used by main (see create_context)
+
 // Number of decimal digits to store 1 quadrillion
 //   (number of zeros: thousand=3, million=6, billion=9, trillion=12, quadrillion=15)
 #define DECLEN 16
@@ -58,55 +66,102 @@
 //   log2(1e15) = 49.82 -->  2^50 > 1e15  --> 51 digits
 #define BINLEN 51
 
+// Size of a cache line (contexts are aligned to, and padded out to, whole cache lines)
+#define CACHE_LINE 64
+
 typedef int32_t Size_t;   // signed for negative index values in for loops
 typedef uint32_t Digit_t;
 typedef uint8_t  Bit_t;
+
+// (C++ already has a bool, which allows this file to be included in the benchmark)
+#ifndef __cplusplus
 typedef uint8_t  bool;
 
 const bool true = 1;
 const bool false = 0;
-
-// Although globals are considered bad form, the need for runtime
-//    efficiency is huge here... so we're going to use them to avoid
-//    passing around pointers to functions (probably overkill, but...
-
-// current base
-Digit_t gN = 0;
-
-// registers
-//   CurNumber   - current Base N palindrome
-//   CurBinary   - CurNumber converted to binary
-//   Div2BufferA - first of two Base N registers for dividing by 2
-//   Div2BufferB - first of two Base N registers for dividing by 2
+#endif
 
 typedef struct {
-  Size_t  size;
-  Digit_t digits[1+DECLEN];   // little-endian, extra digit just in case
+  Size_t   size;
+  Digit_t *digits;   // little-endian, (context's) declen digits
 } Number_t;
 
 typedef struct {
-  Size_t size;
-  Bit_t  bits[5+BINLEN]; // extra bits just in case
+  Size_t  size;
+  Bit_t  *bits;      // little-endian, (context's) binlen bits
 } Binary_t;
 
-Number_t gCurNumber;
-Binary_t gCurBinary;
-Number_t gDiv2BufferA;
-Number_t gDiv2BufferB;
+// Everything a worker needs to search for P(N)
+//   The registers point into the context's own block of memory (see create_context)
+typedef struct {
+  // current base
+  Digit_t N;
+
+  // register sizes
+  Size_t declen;     // Base N digits
+  Size_t binlen;     // bits
 
-//
+  // registers
+  //   CurNumber   - current Base N palindrome
+  //   CurBinary   - CurNumber converted to binary
+  //   Div2BufferA - first of two Base N registers for dividing by 2
+  //   Div2BufferB - first of two Base N registers for dividing by 2
+  Number_t CurNumber;
+  Binary_t CurBinary;
+  Number_t Div2BufferA;
+  Number_t Div2BufferB;
+
+  // result cache
+  // MaxBinary - current max N, expressed in binary
+  Binary_t MaxBinary;
+} __attribute__((aligned(CACHE_LINE))) Context_t;
+
+Context_t *create_context(Size_t declen, Size_t binlen)
+{
+  // Allocates a context whose registers hold up to declen Base N digits or binlen bits.
+  //   The context is followed by the storage for its registers, all in a single block
+  //   of whole cache lines.
+  size_t digits = 3 * declen * sizeof(Digit_t);  // CurNumber, Div2BufferA and Div2BufferB
+  size_t bits   = 2 * binlen * sizeof(Bit_t);    // CurBinary and MaxBinary
+  size_t size   = sizeof(Context_t) + digits + bits;
+  size = CACHE_LINE * ((size + CACHE_LINE - 1) / CACHE_LINE);
+
+  Context_t *ctx = (Context_t *)aligned_alloc(CACHE_LINE, size);
+  if(ctx == NULL) {
+    printf("\nRuntime Error.. failed to allocate a context");
+    exit(1);
+  }
+  memset(ctx, 0, size);
+  ctx->declen = declen;
+  ctx->binlen = binlen;
+
+  Digit_t *d = (Digit_t *)(ctx + 1);
+  ctx->CurNumber.digits   = d;  d += declen;
+  ctx->Div2BufferA.digits = d;  d += declen;
+  ctx->Div2BufferB.digits = d;  d += declen;
+
+  Bit_t *b = (Bit_t *)d;
+  ctx->CurBinary.bits     = b;  b += binlen;
+  ctx->MaxBinary.bits     = b;
 
-// result cache
-// MaxBinary - current max N, expressed in binary
-Binary_t gMaxBinary;
+  return ctx;
+}
 
-Bit_t divmod2(Number_t *d, Number_t *q)
+void destroy_context(Context_t *ctx)
+{
+  free(ctx);
+}
+
+Bit_t divmod2(const Context_t *ctx, const Number_t *d, Number_t *q)
 {
   // This function divides the input dividend (d) by 2.
   // It does not modify the dividend.
   // It stores the quotient in q.
   // It returns the remainder (0 or 1)
   
+  // (a local copy of N, as the stores into q could otherwise alias ctx->N)
+  const Digit_t N = ctx->N;
+
   // start with the number of digits in the divisor
   Size_t   nd = d->size;
   Digit_t msd = d->digits[nd-1];
@@ -128,7 +183,7 @@ Bit_t divmod2(Number_t *d, Number_t *q)
   // set size of the quotient and then begin division, carrying remainder as needed
   q->size = nd;
   for(Size_t i = nd - 1; i>=0; --i) {
-    Digit_t t = R*gN + d->digits[i];
+    Digit_t t = R*N + d->digits[i];
     Digit_t Q = t / 2;
     q->digits[i] = Q;
     R = t - 2*Q;
@@ -138,66 +193,77 @@ Bit_t divmod2(Number_t *d, Number_t *q)
   return R;
 }
 
-void update_binary(void)
+void update_binary(Context_t *ctx)
 {
   // set pointers to the two div2 buffers
-  Number_t *a = &gDiv2BufferA;
-  Number_t *b = &gDiv2BufferB;
+  Number_t *a = &ctx->Div2BufferA;
+  Number_t *b = &ctx->Div2BufferB;
   Number_t *t = NULL; // for swap
+  Bit_t *bits = ctx->CurBinary.bits;
   
   Size_t nbits=0;
-  Bit_t bit = divmod2(&gCurNumber,a);
-  gCurBinary.bits[nbits++] = bit;
+  Bit_t bit = divmod2(ctx,&ctx->CurNumber,a);
+  bits[nbits++] = bit;
   while(a->size) {
-    bit = divmod2(a,b);
-    gCurBinary.bits[nbits++] = bit;
+    if(nbits == ctx->binlen) {
+      printf("\nRuntime Error.. binary exceeds %d bits", ctx->binlen);
+      exit(1);
+    }
+    bit = divmod2(ctx,a,b);
+    bits[nbits++] = bit;
     t = a; a = b; b = t;  // swap and b
   }
-  gCurBinary.size = nbits;
+  ctx->CurBinary.size = nbits;
 }
 
-bool binary_is_palindrome(void)
+bool binary_is_palindrome(const Context_t *ctx)
 {
+  const Bit_t *bits = ctx->CurBinary.bits;
   Size_t a = 0;
-  Size_t b = gCurBinary.size - 1;
+  Size_t b = ctx->CurBinary.size - 1;
   bool rval = true;
   while( rval && a < b ) {
-    rval = ( gCurBinary.bits[a++] == gCurBinary.bits[b--] );
+    rval = ( bits[a++] == bits[b--] );
   }
   return rval;
 }
 
-void next_palindrome(void)
+void next_palindrome(Context_t *ctx)
 {
-  Size_t nd = gCurNumber.size;
+  Number_t *cur = &ctx->CurNumber;
+  Size_t nd = cur->size;
   // nd:(a,b)  ->   3:(1,1), 4:(1,2), 5:(2,2), 6:(2,3)
   Size_t a = (nd-1)/2;
   Size_t b = (nd-1)-a;
   for( ; a >= 0; --a, ++b )
   {
-    Digit_t d = 1 + gCurNumber.digits[a];
-    if( d == gN ) {
-      gCurNumber.digits[a] = 0;
-      gCurNumber.digits[b] = 0;
+    Digit_t d = 1 + cur->digits[a];
+    if( d == ctx->N ) {
+      cur->digits[a] = 0;
+      cur->digits[b] = 0;
     } else {
-      gCurNumber.digits[a] = d;
-      gCurNumber.digits[b] = d;
+      cur->digits[a] = d;
+      cur->digits[b] = d;
       break;
     }
   }
-  if( gCurNumber.digits[0] == 0 ) {
+  if( cur->digits[0] == 0 ) {
     // need to increase length of the palindrome
-    gCurNumber.size = nd+1;
-    gCurNumber.digits[0] = 1;
-    gCurNumber.digits[nd-1] = 0;
-    gCurNumber.digits[nd] = 1;
+    if(nd == ctx->declen) {
+      printf("\nRuntime Error.. palindrome exceeds %d digits", ctx->declen);
+      exit(1);
+    }
+    cur->size = nd+1;
+    cur->digits[0] = 1;
+    cur->digits[nd-1] = 0;
+    cur->digits[nd] = 1;
   }
 }
 
-bool is_next_in_sequence(void) {
+bool is_next_in_sequence(const Context_t *ctx) {
   // returns whether or not current binary is greater than maximum binary so far
-  Size_t curSize = gCurBinary.size;
-  Size_t maxSize = gMaxBinary.size;
+  Size_t curSize = ctx->CurBinary.size;
+  Size_t maxSize = ctx->MaxBinary.size;
   if(curSize > maxSize) { return true; }
   if(curSize < maxSize) { return false; }
   // We're going to take advantage of the fact that we know we are working with
@@ -208,9 +274,9 @@ bool is_next_in_sequence(void) {
   // Strictly speaking, we only need to check the first half of the bits... but
   //   checking all digits will only happen if the numbers are equal, and I
   //   suspect this will be rare enough to ignore.
-  Bit_t *cur = gCurBinary.bits;
-  Bit_t *end = cur + curSize;
-  Bit_t *max = gMaxBinary.bits;
+  const Bit_t *cur = ctx->CurBinary.bits;
+  const Bit_t *end = cur + curSize;
+  const Bit_t *max = ctx->MaxBinary.bits;
   for(; cur<end; ++cur, ++max) {
     if(*cur > *max) { return true; }
     if(*cur < *max) { return false; }
@@ -218,49 +284,51 @@ bool is_next_in_sequence(void) {
   return false;  // aka equal
 }
 
-void update_max_binary(void) {
-  gMaxBinary.size = gCurBinary.size;
-  memcpy(gMaxBinary.bits, gCurBinary.bits, gCurBinary.size * sizeof(Bit_t));
+void update_max_binary(Context_t *ctx) {
+  ctx->MaxBinary.size = ctx->CurBinary.size;
+  memcpy(ctx->MaxBinary.bits, ctx->CurBinary.bits, ctx->CurBinary.size * sizeof(Bit_t));
 }
 
-void display_pn(Size_t seq) {
-  printf("%d: %d\n",seq,gN);
+void find_pn(Context_t *ctx) {
+  // finds P(N) for the context's base (N), leaving it in CurNumber (and CurBinary)
+
+  // initialize the current number to 22 as this is the smallest
+  //   palindrome (regardless of base) that exceeds 2N
+  ctx->CurNumber.size = 2;
+  ctx->CurNumber.digits[0] = 2;
+  ctx->CurNumber.digits[1] = 2;
+  
+  update_binary(ctx);
+  while(!binary_is_palindrome(ctx))
+  {
+    next_palindrome(ctx);
+    update_binary(ctx);
+  }
+}
+
+void display_pn(const Context_t *ctx, Size_t seq) {
+  printf("%d: %d\n",seq,ctx->N);
 }
 
 int main(int argc, const char * argv[]) {
-  // allocate the buffer memory
-  
-  gCurNumber.size=0;
-  gDiv2BufferA.size=0;
-  gDiv2BufferB.size=0;
-  gCurBinary.size=0;
-  gMaxBinary.size=0;
+  // allocate the buffer memory (extra digit and bits just in case)
+  Context_t *ctx = create_context(1+DECLEN, 5+BINLEN);
   
-  // The following is a pseudo-infinite loop. gN will continue increasing
+  // The following is a pseudo-infinite loop. N will continue increasing
   //   until it exceeds the max value for a Digit_t and will then "reset"
   //   to 0.  At that point, the loop will terminate.  Hopefully, a solution
   //   will be found befor that happens and we will break out of the loop.
   Size_t seq = 0;
-  for(gN=3; gN>1; ++gN)
+  for(ctx->N=3; ctx->N>1; ++ctx->N)
   {
-    // initialize the current number to 22 as this is the smallest
-    //   palindrome (regardless of base) that exceeds 2N
-    gCurNumber.size = 2;
-    gCurNumber.digits[0] = 2;
-    gCurNumber.digits[1] = 2;
-    
-    update_binary();
-    while(!binary_is_palindrome())
-    {
-      next_palindrome();
-      update_binary();
-    }
-    if(is_next_in_sequence())
+    find_pn(ctx);
+    if(is_next_in_sequence(ctx))
     {
-      update_max_binary();
-      display_pn(++seq);
+      update_max_binary(ctx);
+      display_pn(ctx,++seq);
       if(seq>100) break;
     }
   }
+  destroy_context(ctx);
   return 0;
 }
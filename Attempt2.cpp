@@ -44,11 +44,59 @@
 //   - does not have an implicit base
 //   - is only valid if the largest digit is less than the base
 // - A "bitstring" is a list of binary digits
+// - A "word" is 64 binary digits
+//   - a binary number is also stored as a little-endian vector of words (Words_t)
+//   - converting a number to words takes one pass over the words for every k digits, where
+//     k is the largest number of digits whose value always fits in a word (N^k <= 2^64),
+//     rather than one pass over the digits for every bit
+//   - the palindrome check is also done a word at a time (see is_binary_palindrome)
+//   - there is no limit on the number of digits (or bits), Attempt2 can go well beyond the 64
+//     and 128 bits of Attempt4
 
 typedef uint8_t                     Bit_t;
 typedef uint64_t                    Digit_t;
+typedef uint64_t                    Word_t;
+typedef unsigned __int128           DWord_t;  // (for the products of two words)
 typedef std::vector<Digit_t>        Number_t;
 typedef std::vector<Bit_t>          Binary_t;
+typedef std::vector<Word_t>         Words_t;
+
+Word_t reverse_word(Word_t w)
+{
+  // reverses the order of all 64 bits of w
+  //   swap adjacent bits, then pairs of bits, then nibbles... and finally the bytes
+  w = ((w >> 1) & 0x5555555555555555ULL) | ((w & 0x5555555555555555ULL) << 1);
+  w = ((w >> 2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) << 2);
+  w = ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  return __builtin_bswap64(w);
+}
+
+void add_words(Words_t &a, const Words_t &b)
+{
+  // adds the binary number b to a (in place)
+  if(a.size() < b.size()) { a.resize(b.size(),0); }
+  Word_t carry = 0;
+  size_t i = 0;
+  for( ; i<b.size(); ++i) {
+    DWord_t t = DWord_t(a[i]) + b[i] + carry;
+    a[i]  = Word_t(t);
+    carry = Word_t(t >> 64);
+  }
+  for( ; carry && i<a.size(); ++i) { carry = (++a[i] == 0); }
+  if( carry ) { a.push_back(carry); }
+}
+
+void mul_word(Words_t &a, Word_t m)
+{
+  // multiplies the binary number a by m (in place)
+  Word_t carry = 0;
+  for(auto wit = a.begin(); wit != a.end(); ++wit) {
+    DWord_t t = DWord_t(*wit) * m + carry;
+    *wit  = Word_t(t);
+    carry = Word_t(t >> 64);
+  }
+  if( carry ) { a.push_back(carry); }
+}
 
 class Base
 {
@@ -57,18 +105,13 @@ class Base
   public:
     Base(Digit_t base) : _N(base), _odd(base % 2 == 1)
     {
-      // As division and modulus are expensive from a runtime POV and as one of the expected
-      //   bottlenecks will be converting number to binary, we are going to precompute the
-      //   quotient and remainder when dividing any number in the range 0 to 2N-1 by 2.
-      // To improve retrieval efficiency, the will be stored in an array of 2 vectors:
-      //   0 to  N-1 will be stored in the first row  (single digit base N numbers)
-      //   N to 2N-1 will be stored in the second row (two digit base N numbers where first digit is 1)
-      for(Digit_t i=0; i<2*base; ++i)
-      {
-        _Q2[i/base].push_back(i/2);
-        _R2[i/base].push_back(i%2);
-      }
-      
+      // As one of the expected bottlenecks will be converting numbers to binary, we are
+      //   going to precompute the powers of N up to the largest that fits in a word (N^k).
+      //   The conversion then absorbs k digits at a time into the words (see words)
+      _Nk.push_back(1);
+      while( _Nk.back() <= ~Word_t(0) / base ) { _Nk.push_back( base * _Nk.back() ); }
+      _k = _Nk.size() - 1;
+
       // In order preallocate arrays of bits when converting to binary, it is useful to have
       //   an upper bound on the number of bits to expect for an M digit base N number.
       //   - any M digit base N number will be less than N^M
@@ -82,39 +125,59 @@ class Base
   
     Digit_t N() const { return _N; }
 
-    bool divmod2(Number_t &n) const
+    void words(const Number_t &n, Words_t &w) const
     {
-      // This function divides the input number by 2
-      // Note that this modifies the input number in place
-      // It returns a boolean indicating if there was or was a remainder (i.e. odd or even)
-      bool R = false;
-      auto dit = n.rbegin();
-      if(*dit < 2) {
-        R = true;
-        *(dit++) = 0;
-      }
-      Digit_t Q(0);
-      while( dit != n.rend() ) {
-        Q = _Q2[R][*dit];
-        R = _R2[R][*dit];
-        *(dit++) = Q;
-      }
-      if(n.back() == 0) {
-        n.pop_back();
+      // Converts the input number to binary words (little-endian)
+      //   Working down from the most significant digit, each chunk of (up to) k digits
+      //   is added into the words as a single multiply-accumulate pass:
+      //      w = N^k * w + (value of the k digits)
+      //   The top chunk takes whatever is left over after splitting the rest into k
+      //   digit chunks, so the chunks line up with the least significant digit.
+      w.clear();
+      w.reserve(1 + ceil(n.size() * _log2N / 64));
+      size_t i = n.size();
+      size_t c = (i % _k) ? (i % _k) : _k;
+      while( i > 0 ) {
+        Word_t chunk = 0;
+        for(size_t j=0; j<c; ++j) { chunk = _N * chunk + n[--i]; }
+
+        Word_t Nc    = _Nk[c];
+        Word_t carry = chunk;
+        for(auto wit = w.begin(); wit != w.end(); ++wit) {
+          DWord_t t = DWord_t(*wit) * Nc + carry;
+          *wit  = Word_t(t);
+          carry = Word_t(t >> 64);
+        }
+        if( carry ) { w.push_back(carry); }
+        c = _k;
       }
-      return R;
+    }
+
+    static bool is_binary_palindrome(const Words_t &w)
+    {
+      // Checks if the binary number in the words (with no leading zero words) is a palindrome
+      //   The number is a palindrome if it is equal to its bit reversal:  the words in
+      //   reverse order, each with its bits reversed, shifted down by the number of
+      //   leading zeros in the top word (s).
+      //   The words are compared from the least significant word up, so that (almost) all of
+      //   the non-palindromes are rejected after the first word.
+      size_t   nw = w.size();
+      unsigned s  = __builtin_clzll(w.back());
+      auto rev = [&](size_t i) { return i < nw ? reverse_word(w[nw-1-i]) : Word_t(0); };
+      for(size_t i=0; i<nw; ++i) {
+        Word_t r = s ? ( (rev(i) >> s) | (rev(i+1) << (64-s)) ) : rev(i);
+        if( r != w[i] ) { return false; }
       }
-    
+      return true;
+    }
+
     Digit_t divmod(Number_t &n,Digit_t base) const
     {
       // This function divides the input number by input divisor
       //   Note that this modifies the input number in place
       //   It returns the remainder
-      // This function is essentially identical to divmod2 except that
-      //   where divmod2 is called many many times while trying to find P[N],
-      //   divmod will only be called once P[N] has been found and
-      //   we need to convert it to a an other base.  There is no need
-      //   to precompute the q,r pairs for arbitrary base
+      // This function is only called once P[N] has been found and we need to convert
+      //   it to a an other base (e.g. decimal)
       Digit_t Q = 0;
       Digit_t R = 0;
       auto dit = n.rbegin();
@@ -148,39 +211,31 @@ class Base
       }
       if(parity % 2 == 0) { return Binary_t(); }
       
-      Binary_t bits = binary(n);
-      
-      // check for palindrome (itsif applicable)
-      uint16_t nbits = bits.size();
-      for(uint16_t i=0; i<nbits/2; ++i) {
-        if ( bits[i] != bits[nbits-1-i] ) {
-          bits.clear();
-          break;
-        }
-      }
-      
-      return bits;
+      // check for palindrome a word at a time, only the palindromes are converted to bits
+      //   (_words is reused from one call to the next, so there's no allocation per number)
+      words(n,_words);
+      if( !is_binary_palindrome(_words) ) { return Binary_t(); }
+
+      return bits(_words);
     }
   
     Binary_t binary(const Number_t &n, bool only_palindrome=false) const
     {
       // Converts the input number to binary.
+      words(n,_words);
+      return bits(_words);
+    }
+
+    Binary_t bits(const Words_t &w) const
+    {
+      // Converts binary words to a (little-endian) bitstring
       Binary_t bits;
-      
-      // as divmod2 modifies the number passed it, we need a non-const
-      //   copy of n to work with
-      Number_t digits(n);
-      
-      // to avoid unnecessary resizing, let's reserve enough space in the
-      //   return value (bits) to hold all the binary digits
-      bits.reserve(1 + ceil(digits.size() * _log2N));
-    
-      // create (little-endian) binary number by repeatedly
-      //   dividing n by 2 and recording the remainder until n=0
-      while(!digits.empty()) {
-        bits.push_back( divmod2(digits) );
+      bits.reserve(64 * w.size());
+      for(auto wit = w.begin(); wit != w.end(); ++wit) {
+        for(unsigned i=0; i<64; ++i) { bits.push_back( (*wit >> i) & 1 ); }
       }
-      
+      // drop the leading zeros of the top word
+      while(!bits.empty() && bits.back() == 0) { bits.pop_back(); }
       return bits;
     }
 
@@ -222,9 +277,10 @@ class Base
   private:
     Digit_t              _N;     // the base
     bool                 _odd;   // flag indicating that the base is odd
-    std::vector<Digit_t> _Q2[2]; // see description in constructor
-    std::vector<bool>    _R2[2]; // see description in constructor
+    std::vector<Word_t>  _Nk;    // N^0, N^1, ..., N^k (see description in constructor)
+    size_t               _k;     // number of digits absorbed into the words per pass
     double               _log2N; // see description in constructor
+    mutable Words_t      _words; // scratch space for the conversion to words
 };
 
 std::ostream &operator<<(std::ostream &s, const Binary_t &bits)
@@ -290,6 +346,19 @@ class Palindromes
   //     if just finished odd palindrome length (2m-1 digits), go on to 2m digits
   //     if just finished even length, increment m and start with odd length
   //
+  // A binary copy of the palindrome (words) is kept alongside its digits, so that it never
+  //   needs to be converted.  Every increment of the kernel changes the palindrome by the
+  //   same amount (delta) for a given number of kernel digits (j) that roll over:
+  // - j=0:  delta = N^a + N^b   (just N^a for the middle digit of an odd length, a=b)
+  // - j>0:  digits a(0)...a(j-1) and their mirrors go from N-1 to 0 and digit a(j) (and
+  //         its mirror) goes up by 1.  The digits that roll over are contiguous, from b(j)+1
+  //         up to a(j)-1, so
+  //           delta = N^a(j) + N^b(j) - (N-1)*(N^b(j)+1 + ... + N^a(j)-1)
+  //                 = N^a(j) + N^b(j) - (N^a(j) - N^b(j)+1)
+  //                 = (N+1) N^b(j)
+  // - and once all of the kernel digits roll over (XXX...XXX), +2 moves on to 1000...0001
+  // The deltas are computed whenever the length changes.
+  //
   //--------------------------------------------------------------------
   // Refer to the following graphic to understand how this looks:
   //--------------------------------------------------------------------
@@ -396,8 +465,10 @@ class Palindromes
   
 public:
   // we seed the sequence with 11 so that the first call to next will yield 22
-  Palindromes(Digit_t base) : _N(base), _n(2), _cur({1,1})
-  {}
+  Palindromes(Digit_t base) : _N(base), _n(2), _cur({1,1}), _words({base+1})
+  {
+    set_deltas();
+  }
   
   const Number_t &next()
   {
@@ -410,8 +481,9 @@ public:
     // b: 0 1 1 2 2 3 3 4   m-1
     uint32_t a = _n/2;
     uint32_t b = (_n-1)/2;
+    uint32_t j = 0;  // number of kernel digits that rolled over
     
-    while( a < _n ) {
+    for( ; a < _n; ++j ) {
       if( _cur[a] < _N-1 ) {
         _cur[a] = _cur[b] = 1 + _cur[a];
         break;
@@ -428,26 +500,58 @@ public:
       _cur[0] = 1;
       _cur.push_back(1);
       _n = _n + 1;
+      add_words(_words, Words_t(1,2));
+      set_deltas();
+    } else {
+      add_words(_words, _delta[j]);
     }
 
     return _cur;
   }
+
+  // the current palindrome in binary (see Base::words)
+  const Words_t &words() const { return _words; }
   
 private:
+  void set_deltas()
+  {
+    // computes the deltas for the current length (see description above)
+    //   a(0) = n/2, b(0) = (n-1)/2 and b(j) = b(0)-j for j in [0,m)
+    uint32_t a0 = _n/2;
+    uint32_t b0 = (_n-1)/2;
+    std::vector<Words_t> powers(1, Words_t(1,1));  // N^0, N^1, ..., N^a(0)
+    for(uint32_t i=1; i<=a0; ++i) {
+      powers.push_back(powers.back());
+      mul_word(powers.back(), _N);
+    }
+
+    _delta.assign(_n - a0, Words_t());
+    _delta[0] = powers[a0];
+    if( a0 != b0 ) { add_words(_delta[0], powers[b0]); }
+    for(uint32_t j=1; j<_delta.size(); ++j) {
+      _delta[j] = powers[b0-j];
+      mul_word(_delta[j], _N+1);
+    }
+  }
+
   Digit_t  _N;    // numeric base for the palindrome
   uint32_t _n;    // crurrent length of the palindrome
   Number_t _cur;  // current palindrome
+  Words_t  _words;               // current palindrome in binary
+  std::vector<Words_t> _delta;   // change in the palindrome for j kernel digits rolling over
 };
 
 
 Number_t P(Base &base)
 {
   // computes the value of P(N)
+  //   the palindromes are kept in binary as they're generated, so there's no conversion
+  //   (only odd numbers can be binary palindromes, see binary_if_palindrome)
   Palindromes p(base.N());
   while(true) {
     const Number_t &n = p.next();
-    Binary_t bits = base.binary_if_palindrome(n);
-    if(!bits.empty()) {
+    const Words_t  &w = p.words();
+    if( (w.front() & 1) && Base::is_binary_palindrome(w) ) {
       return n;
     }
   }
@@ -470,4 +574,5 @@ int main(int argc, char **argv)
       std::cout << ++nfound << ": " << i << " " << pn << " " << base.decimal(pn) << " " << base.binary(pn) << std::endl;
     }
   }
+  return 0;
 }
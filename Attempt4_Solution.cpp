@@ -41,21 +41,334 @@
 //      - 2^64 = (2^10)^6 * 2^4 = 16 * (1024)^6, which is slightly larger than 1.6e19
 //      - 1 quadrillion = 1e15
 //      - unless P(N) completely jumps over the quadrillions into the 10s of quintillions, we should be ok
+//      - and for targets beyond that, the generator and checker are templates on the type of
+//        the palindromes, so any base whose P(N) doesn't fit in 64 bits continues its search
+//        with 128 bit palindromes (see calc_Pn_wide)
 //   - We can generate Base-N palindromes directly through a strategic sequences of additions
 //      - the algorithm for generating the palindromes is described at the end of this file
 //   - We are going WAY BACK here and using a pseudo Turing machine to encode the sequence
 //      - A new sequence machine is needed for each base examined
+//      - its operations are rebuilt in place in a per-thread arena rather than reallocated
+//        (see BasicOperationArena)
+//
+// - Parallel sweep
+//   - Each P(N) is independent of all the others, so bases can be examined concurrently
+//   - Run with --threads <n> to hand out blocks of bases to n worker threads
+//   - Results are reduced in N order, so the reported sequence matches the serial run
+//
+// - Engines
+//   - The tree of operations (Generator) is retained as the reference implementation
+//   - For an even N, the outer digits whose palindromes can't be binary palindromes (e.g. all
+//     even outer digits) can be skipped (see BasicOuterDigitFilter, used by the masked engine
+//     and the 128 bit search of the wide engine)
+//   - Faster engines are selected with --engine <name>
+//   - All engines can be cross-checked against the reference with --verify <N0:N1>, or over
+//     the ranges that have turned up engine bugs before with --verify regressions
+//   - The batch engine uses AVX2/AVX-512 when available (e.g. compile with -march=native)
+//   - --bounded replaces the search for P(N) with a search for any double palindrome below the
+//     largest P(N) so far, split across the threads (see BoundedSearch)
+//   - Long sweeps can be checkpointed (--checkpoint) and picked up again later (--resume)
+//   - A sweep can be split across machines, each sweeping one shard of the bases (--shard or
+//     --range) and the shards merged back into the full solution sequence (--merge)
+//   - Per-base statistics (time, candidates, ...) can be written to a CSV file (--stats)
+//   - Range mode engines (e.g. sieve) compute P(N) for a whole block of bases (--block) at once
+//   - --split keeps an expensive base from holding up a parallel sweep, once its search runs
+//     over a time budget the rest of it is handed out in chunks to the idle threads
+//     (see HybridScheduler)
+//   - The lanes engine searches the 2 and 3 digit palindromes of a block of bases, one base
+//     in each lane of the SIMD binary palindrome check (see LaneSearch)
+//   - Progress of each thread (N, bases/s, candidates/s, L) is reported on SIGUSR1 and,
+//     optionally, every few seconds (--progress, --status), from running totals that each
+//     thread keeps (nothing is kept when neither is asked for)
+//   - Compiling with -DPALINDROME_PERF (Linux) prints hardware performance counters (cycles,
+//     instructions, branch and L1 misses) for calc_Pn and its stages at exit (see PerfCounters)
+//   - P(N) of every base (not just the records) can be saved to a fixed width binary table
+//     (--table), which --query reads back (memory mapped) without computing P(N) again
+//   - The binary palindromes can be generated once into an index file (--build-index) that the
+//     binary first and sieve engines then read (memory mapped) instead (--index)
 //-------------------------------------------------------------------------------------------------
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <iomanip>
 #include <limits>
+#include <climits>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
 #include <vector>
+#include <map>
+#include <memory>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 typedef uint64_t Number_t;
 typedef uint64_t Count_t;
+typedef unsigned __int128 Wide_t;  // P(N) values that outgrow 64 bits (see calc_Pn_wide)
+
+struct SearchCounters
+{
+  // Counts of the candidates examined by the palindrome checks (see --stats), maintained
+  //   per thread, but only when compiled with -DPALINDROME_STATS.  Otherwise, the counts
+  //   cost nothing as they are never updated (and always 0).
+  Count_t tested;         // candidates checked for being a binary (or base-N) palindrome
+  Count_t early_rejects;  // candidates rejected without a full check (even or 16 bit mismatch)
+  Count_t passed;         // candidates that were palindromes
+};
+thread_local SearchCounters search_counters = {0,0,0};
+
+#ifdef PALINDROME_STATS
+#define COUNT_SEARCH(counter,n) (search_counters.counter += (n))
+const bool search_counts = true;   // (see StatsSink)
+#else
+#define COUNT_SEARCH(counter,n)
+const bool search_counts = false;
+#endif
+
+#ifdef PALINDROME_PERF
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+class PerfCounters
+{
+  // Hardware performance counters (perf_event_open) of the calling thread, only compiled in
+  //   with -DPALINDROME_PERF (Linux).  See PERF_SCOPE below.
+  //   - the counts for each stage are totalled per thread and printed to stderr at exit
+  //   - counters that the kernel (or VM) doesn't provide are left out (shown as "-")
+  //   - the counts of hidden scopes (see PerfReplay) are subtracted from all enclosing scopes
+public:
+  enum Stage   { calc_Pn, calc_Pn_range, search, generate, nstages };
+  enum Counter { task_clock, cycles, instructions, branch_misses, l1d_misses, ncounters };
+
+  struct Totals
+  {
+    Count_t calls;
+    Count_t counts[ncounters];
+  };
+
+private:
+  int      _leader;               // group leader (-1 if no counters are available)
+  unsigned _nopen;                // number of counters in the group
+  unsigned _counter[ncounters];   // counter of each value read from the group
+  bool     _available[ncounters];
+  Count_t  _hidden[ncounters];    // total counts of the hidden scopes
+  Totals   _totals[nstages];
+
+public:
+  PerfCounters() : _leader(-1), _nopen(0)
+  {
+    memset(_available, 0, sizeof(_available));
+    memset(_hidden, 0, sizeof(_hidden));
+    memset(_totals, 0, sizeof(_totals));
+
+    const Count_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D 
+      | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const unsigned types[ncounters]  = { PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, 
+                                         PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+    const Count_t configs[ncounters] = { PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_CPU_CYCLES, 
+                                         PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, l1d_read_miss };
+    for(unsigned c=0; c<ncounters; ++c) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = types[c];
+      attr.config         = configs[c];
+      attr.read_format    = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      int fd = syscall(SYS_perf_event_open, &attr, 0, -1, _leader, 0);
+      if(fd < 0) { continue; }
+      if(_leader < 0) { _leader = fd; }
+      _counter[_nopen++] = c;
+      _available[c] = true;
+    }
+  }
+
+  ~PerfCounters();
+
+  bool available(Counter c) const { return _available[c]; }
+
+  void read(Count_t *counts)
+  {
+    // current counts, less those of the hidden scopes
+    struct { uint64_t nr; uint64_t values[ncounters]; } group;
+    memset(counts, 0, ncounters*sizeof(Count_t));
+    if(_leader < 0 || ::read(_leader, &group, sizeof(group)) < 0) { return; }
+    for(unsigned i=0; i<_nopen; ++i) { 
+      counts[_counter[i]] = group.values[i] - _hidden[_counter[i]]; 
+    }
+  }
+
+  void add(Stage stage, const Count_t *start, bool hidden)
+  {
+    // adds the counts since start to the totals for the stage
+    Count_t counts[ncounters];
+    read(counts);
+    ++_totals[stage].calls;
+    for(unsigned c=0; c<ncounters; ++c) {
+      _totals[stage].counts[c] += counts[c] - start[c];
+      if(hidden) { _hidden[c] += counts[c] - start[c]; }
+    }
+  }
+};
+
+class PerfReport
+{
+  // Collects the totals of each thread as it exits, printed to stderr at exit
+  //   IPC = instructions/cycle, misses are per 1000 instructions
+  //   check = search - generate (the time spent in the binary palindrome checks)
+private:
+  std::mutex _mutex;
+  std::vector< std::vector<PerfCounters::Totals> > _threads;
+  bool _available[PerfCounters::ncounters];
+
+public:
+  static PerfReport &instance()
+  {
+    static PerfReport report;
+    return report;
+  }
+
+  void add(const PerfCounters &counters, const PerfCounters::Totals *totals)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(unsigned c=0; c<PerfCounters::ncounters; ++c) {
+      _available[c] = counters.available(PerfCounters::Counter(c));
+    }
+    bool used = false;
+    for(unsigned s=0; s<PerfCounters::nstages; ++s) { used = used || totals[s].calls > 0; }
+    if(used) { _threads.push_back( std::vector<PerfCounters::Totals>(totals, totals+PerfCounters::nstages) ); }
+  }
+
+  ~PerfReport()
+  {
+    if(_threads.empty()) { return; }
+    std::vector<PerfCounters::Totals> all(PerfCounters::nstages);
+    memset(all.data(), 0, all.size()*sizeof(PerfCounters::Totals));
+    for(size_t t=0; t<_threads.size(); ++t) {
+      std::cerr << "perf counters: thread " << t+1 << std::endl;
+      print(_threads[t]);
+      for(unsigned s=0; s<PerfCounters::nstages; ++s) {
+        all[s].calls += _threads[t][s].calls;
+        for(unsigned c=0; c<PerfCounters::ncounters; ++c) { all[s].counts[c] += _threads[t][s].counts[c]; }
+      }
+    }
+    if(_threads.size() > 1) {
+      std::cerr << "perf counters: all threads" << std::endl;
+      print(all);
+    }
+  }
+
+private:
+  void print(const std::vector<PerfCounters::Totals> &totals) const
+  {
+    static const char *stages[] = { "calc_Pn", "calc_Pn_range", "search", "generate", "check" };
+    std::cerr << "  " << std::setw(14) << std::left << "stage" << std::right << std::setw(12) << "calls"
+      << std::setw(12) << "ms" << std::setw(16) << "cycles" << std::setw(16) << "instructions"
+      << std::setw(8) << "IPC" << std::setw(16) << "branch-misses" << std::setw(10) << "/1k ins"
+      << std::setw(16) << "L1d-misses" << std::setw(10) << "/1k ins" << std::endl;
+
+    PerfCounters::Totals check = totals[PerfCounters::search];
+    for(unsigned c=0; c<PerfCounters::ncounters; ++c) { 
+      check.counts[c] -= std::min(check.counts[c], totals[PerfCounters::generate].counts[c]); 
+    }
+    for(unsigned s=0; s<=PerfCounters::nstages; ++s) {
+      const PerfCounters::Totals &t = (s < PerfCounters::nstages) ? totals[s] : check;
+      if(t.calls == 0 || (s == PerfCounters::nstages && totals[PerfCounters::generate].calls == 0)) { continue; }
+      std::cerr << "  " << std::setw(14) << std::left << stages[s] << std::right << std::setw(12) << t.calls;
+      field(t, PerfCounters::task_clock, 12, 1e-6);
+      field(t, PerfCounters::cycles, 16, 1);
+      field(t, PerfCounters::instructions, 16, 1);
+      ratio(t, PerfCounters::instructions, PerfCounters::cycles, 8, 1);
+      field(t, PerfCounters::branch_misses, 16, 1);
+      ratio(t, PerfCounters::branch_misses, PerfCounters::instructions, 10, 1000);
+      field(t, PerfCounters::l1d_misses, 16, 1);
+      ratio(t, PerfCounters::l1d_misses, PerfCounters::instructions, 10, 1000);
+      std::cerr << std::endl;
+    }
+  }
+
+  void field(const PerfCounters::Totals &t, PerfCounters::Counter c, int width, double scale) const
+  {
+    if(!_available[c]) { std::cerr << std::setw(width) << "-"; return; }
+    std::cerr << std::setw(width) << std::fixed << std::setprecision(scale < 1 ? 1 : 0) << t.counts[c]*scale;
+  }
+
+  void ratio(const PerfCounters::Totals &t, PerfCounters::Counter a, PerfCounters::Counter b, int width, double scale) const
+  {
+    if(!_available[a] || !_available[b] || t.counts[b] == 0) { std::cerr << std::setw(width) << "-"; return; }
+    std::cerr << std::setw(width) << std::fixed << std::setprecision(2) << scale*t.counts[a]/t.counts[b];
+  }
+};
+
+PerfCounters::~PerfCounters()
+{
+  PerfReport::instance().add(*this, _totals);
+  if(_leader >= 0) { close(_leader); }
+}
+
+thread_local PerfCounters perf_counters;
+
+class PerfScope
+{
+  // accumulates the counts from construction to destruction into the thread's totals for a stage
+private:
+  PerfCounters::Stage _stage;
+  bool                _hidden;
+  Count_t             _start[PerfCounters::ncounters];
+
+public:
+  PerfScope(PerfCounters::Stage stage, bool hidden=false) : _stage(stage), _hidden(hidden)
+  {
+    PerfReport::instance();  // (constructed before, and so destroyed after, perf_counters)
+    perf_counters.read(_start);
+  }
+  ~PerfScope() { perf_counters.add(_stage, _start, _hidden); }
+};
+
+template<class Generator_t, class Value_t>
+class PerfReplay
+{
+  // Splits a search of the palindromes of length L into its generator and checker stages
+  //   by re-running the generator (without any checks) until it reaches the palindrome on
+  //   which the search stopped.  The replay is hidden from the enclosing stages.
+private:
+  Number_t       _N;
+  Count_t        _L;
+  Value_t        _p0;
+  const Value_t &_p;
+
+public:
+  PerfReplay(Number_t N, Count_t L, const Value_t &p) : _N(N), _L(L), _p0(p), _p(p) {}
+  ~PerfReplay()
+  {
+    PerfScope scope(PerfCounters::generate, true);
+    Generator_t g(_N,_L);
+    Value_t q = _p0;
+    while(q != _p && g.step(q)) {}
+  }
+};
+
+#define PERF_SCOPE(stage) PerfScope perf_scope(PerfCounters::stage)
+#define PERF_REPLAY(Generator_t,N,L,p) PerfReplay<Generator_t,decltype(p)> perf_replay(N,L,p)
+#else
+#define PERF_SCOPE(stage)
+#define PERF_REPLAY(Generator_t,N,L,p)
+#endif
 
 std::string hh_mm_ss(time_t t)
 {
@@ -68,7 +381,7 @@ std::string hh_mm_ss(time_t t)
   return rval.str();
 }
 
-std::string add_commas(Number_t n)
+std::string add_commas(Wide_t n)
 {
   // used for displaying the decimal values of P(N) displayed to stdout
   // adds commas between each group of 3 digits (units, thousands, millions, etc.)
@@ -78,49 +391,181 @@ std::string add_commas(Number_t n)
     n /= 1000;
   }
   std::stringstream rval;
-  rval << n;
+  rval << Number_t(n);
   for(auto bi = blocks.rbegin(); bi!=blocks.rend(); ++bi) {
     rval << "," << std::setw(3) << std::setfill('0') << *bi;
   }
   return rval.str();
 }
 
-std::string base_n_str(Number_t n, Number_t N)
+class Divider
+{
+  // Division of 64 bit numbers by an invariant divisor (d).
+  //   Hardware division is expensive (40+ cycles for 64 bits on x86), but division by a
+  //   constant can be done with a multiply by a precomputed reciprocal ("magic number")
+  //   followed by a shift (Granlund & Montgomery, as implemented in libdivide).
+  //   - l = floor(log2(d)), magic = floor(2^(64+l)/d) + 1, quotient = (n * magic) >> (64+l)
+  //   - for some d, that magic number needs 65 bits.  In that case, the 65th bit is handled
+  //     by adding back n (the "add" indicator in the code below)
+  //   - powers of 2 only need the shift
+
+private:
+  Number_t _d;      // the divisor
+  Number_t _magic;  // (0 for powers of 2)
+  unsigned _shift;
+  bool     _add;
+
+public:
+  Divider(Number_t d) : _d(d), _magic(0), _shift(63 - __builtin_clzll(d)), _add(false)
+  {
+    if(d & (d-1)) {
+      unsigned __int128 num = (unsigned __int128)(1) << (64 + _shift);
+      Number_t m   = Number_t(num / d);
+      Number_t rem = Number_t(num - (unsigned __int128)(m) * d);
+      if(d - rem >= (Number_t(1) << _shift)) {
+        // doesn't fit in 64 bits
+        m += m;
+        Number_t twice_rem = rem + rem;
+        if(twice_rem >= d || twice_rem < rem) { m += 1; }
+        _add = true;
+      }
+      _magic = m + 1;
+    }
+  }
+
+  Number_t divisor() const { return _d; }
+
+  Number_t quotient(Number_t n) const
+  {
+    if(_magic == 0) { return n >> _shift; }
+    Number_t q = Number_t( ((unsigned __int128)(_magic) * n) >> 64 );
+    if(_add) { q = ((n - q) >> 1) + q; }
+    return q >> _shift;
+  }
+
+  // returns the quotient, replacing n with the remainder
+  Number_t divmod(Number_t &n) const
+  {
+    Number_t q = quotient(n);
+    n -= q * _d;
+    return q;
+  }
+};
+
+std::string base_n_str(Wide_t wide_n, Number_t N)
 {
   // used for displaying P(N) to stdout in a given base N (which could be 2 for binary)
   // we take dvantage of the fact we know n is a base N (or 2) palindrome and actually 
   //   display the number in a little-endian order (which matches the traditional big-endian
   //   order for a palindrome).
+  // Any digits beyond 64 bits are peeled off with (slow) 128 bit divisions
+  Divider divN(N);
   std::stringstream rval;
-  while(n) {
-    if(N<=10) { rval << n%N; }
-    else      { rval << "(" << (n%N) << ")"; }
-    n /= N;
+  while(wide_n) {
+    Number_t d;
+    if(wide_n > ULLONG_MAX) {
+      d = Number_t(wide_n % N);
+      wide_n /= N;
+    } else {
+      Number_t n = Number_t(wide_n);
+      d = n;
+      wide_n = divN.divmod(d);
+    }
+    if(N<=10) { rval << d; }
+    else      { rval << "(" << d << ")"; }
   }
   return rval.str();
 }
 
-class Operation
+std::string wide_str(Wide_t n)
+{
+  // decimal representation of n (there is no operator<< for 128 bit integers)
+  if(n <= ULLONG_MAX) { return std::to_string(Number_t(n)); }
+  std::string rval;
+  for( ; n; n/=10) { rval.insert(rval.begin(), char('0' + n%10)); }
+  return rval;
+}
+
+Wide_t strtowide(const char *str, char **end)
+{
+  // same as std::strtoull (base 10), but for 128 bit integers
+  //   saturates at the largest Wide_t on overflow
+  Wide_t n = 0;
+  for( ; *str >= '0' && *str <= '9'; ++str) {
+    if(__builtin_mul_overflow(n, Wide_t(10), &n) || __builtin_add_overflow(n, Wide_t(*str - '0'), &n)) {
+      n = ~Wide_t(0);
+    }
+  }
+  if(end) { *end = const_cast<char *>(str); }
+  return n;
+}
+
+unsigned bit_length(Number_t n)
+{
+  // number of bits needed to represent n (0 for n=0)
+  return n ? 64 - __builtin_clzll(n) : 0;
+}
+
+Number_t low_mask(unsigned nbits)
+{
+  // binary number with only the lowest nbits set to 1
+  return (nbits >= 64) ? ~Number_t(0) : (Number_t(1) << nbits) - 1;
+}
+
+Number_t reverse64(Number_t n)
+{
+  // reverses the order of all 64 bits of n
+  //   swap adjacent bits, then pairs of bits, then nibbles... and finally the bytes
+  n = ((n >> 1) & 0x5555555555555555ULL) | ((n & 0x5555555555555555ULL) << 1);
+  n = ((n >> 2) & 0x3333333333333333ULL) | ((n & 0x3333333333333333ULL) << 2);
+  n = ((n >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((n & 0x0F0F0F0F0F0F0F0FULL) << 4);
+  return __builtin_bswap64(n);
+}
+
+Number_t reverse_bits(Number_t n, unsigned nbits)
+{
+  // reverses the order of the lowest nbits of n
+  return (nbits == 0) ? 0 : reverse64(n) >> (64-nbits);
+}
+
+template<class Value_t>
+class BasicOperation
 {
   // Operation is the base class for all atomic and composite
   //   operations in a palindrome generation sequence
+  // Value_t is the type of the palindromes: Number_t (see the typedefs following Generator)
+  //   or Wide_t for the palindromes that don't fit in 64 bits (see calc_Pn_wide)
 public:
   // the step function updates the provided palindrome and returns
   // whether or not there are more iteration required to complete the operation:
   //   true if the operation is NOT complete
   //   false if the operation IS complete
-  virtual bool step(Number_t &palindrome) = 0;
-  virtual ~Operation() {}
+  virtual bool step(Value_t &palindrome) = 0;
+
+  // Random access (see Generator::seek)
+  //   size:  number of steps needed to complete the operation
+  //   total: sum of all of the additions made over those steps
+  //   seek:  puts the operation into the state it would be in after k steps from its reset
+  //          state (k < size) and returns the sum of the additions made by those k steps
+  //   (the counts are also Value_t as there may be more than 2^64 palindromes of a length)
+  virtual Value_t size() const = 0;
+  virtual Value_t total() const = 0;
+  virtual Value_t seek(Value_t k) = 0;
+
+  virtual ~BasicOperation() {}
 };
 
-// we're going to include these in std containers, to make this more readable,
-//   we'll define the following typedefs
-typedef Operation            *OpPtr_t;
-typedef std::vector<OpPtr_t>  OpList_t;
-typedef OpList_t::iterator    OpIter_t;
+template<class Value_t>
+void insufficient_bits()
+{
+  // the palindromes have outgrown Value_t
+  std::cout << 8*sizeof(Value_t) << "bit is insufficient" << std::endl;
+  exit(1);
+}
 
 
-class Increment : public Operation {
+template<class Value_t>
+class BasicIncrement : public BasicOperation<Value_t> {
   // The Increment operation updates the palindrom by adding a
   //   specified increment (adder) a specified number of times (n).
   // Each call to the step method makes a single addition.
@@ -128,22 +573,27 @@ class Increment : public Operation {
   // the operation resets after completion, ready for another series of invocations.
 
 private:
-  const Number_t _adder;    // number to add each step
-  const Count_t  _repeat;   // number of times to repeat the addition
-  Count_t        _counter;  // number of times the addition has been done so far
+  Value_t  _adder;    // number to add each step
+  Count_t  _repeat;   // number of times to repeat the addition
+  Count_t  _counter;  // number of times the addition has been done so far
 
 public:
   // constructor simply set the initial values fo each attribute
-  Increment(Count_t n,Number_t adder) : _adder(adder), _repeat(n), _counter(0)
+  BasicIncrement(Count_t n=0,Value_t adder=0) : _adder(adder), _repeat(n), _counter(0)
   {}
 
-  virtual bool step(Number_t &palindrome)
+  // rebuilds the operation in place (see BasicOperationArena)
+  void init(Count_t n, Value_t adder)
+  {
+    _adder   = adder;
+    _repeat  = n;
+    _counter = 0;
+  }
+
+  // (Overflow is never checked here.  It can only happen in the palindromes of a length
+  //   that doesn't fit in Value_t, whose searches are checked instead, see search_palindromes)
+  virtual bool step(Value_t &palindrome)
   {
-    // let's make sure we don't overflow our 64 bit limit
-    if(palindrome > ULLONG_MAX - _adder) {
-      std::cout << "64bit is insufficient" << std::endl;
-      exit(1);
-    }
     // perform the addition and increment the counter
     palindrome += _adder;
     _counter += 1;
@@ -160,10 +610,86 @@ public:
     //   required to complete the operation
     return true; // not yet done
   }
+
+  virtual Value_t size() const  { return _repeat; }
+  virtual Value_t total() const { return _repeat * _adder; }
+
+  virtual Value_t seek(Value_t k)
+  {
+    _counter = k;
+    return k * _adder;
+  }
 };
 
 
-class PairedOps : public Operation {
+template<class Value_t>
+unsigned value_bit_length(Value_t n)
+{
+  // bit_length of a Number_t or Wide_t
+  if constexpr (sizeof(Value_t) > sizeof(Number_t)) {
+    Number_t hi = Number_t(n >> 64);
+    if(hi) { return 64 + bit_length(hi); }
+  }
+  return bit_length(Number_t(n));
+}
+
+template<class Value_t>
+class BasicOuterDigitFilter
+{
+  // Rules out the outer digits (a) of the length L palindromes of an even base (N) whose
+  //   palindromes cannot be binary palindromes, so that the Generator can skip them entirely
+  //   (see BasicPairedOps::skip_outer).
+  // When 2^s divides N, every palindrome with outer digit a is a (mod N), so its lowest s bits
+  //   are those of a:
+  //   - binary palindromes are odd, which rules out every even a (i.e. half of the outer digits)
+  //   - the lowest t bits of a B bit binary palindrome are its top t bits reversed (t <= B/2).
+  //     The palindromes with outer digit a lie in [a*N^(L-1)+a, (a+1)*N^(L-1)), if all of them
+  //     have the same B and top t bits, the lowest min(s,t) bits of a must be their reverse.
+  // Each outer digit is only tested once the Generator gets to it, so there is no cost for
+  //   the outer digits beyond P(N).
+
+private:
+  unsigned _s;   // largest s such that 2^s divides N (0 if the filter is off)
+  Value_t  _NL;  // N^(L-1)
+
+public:
+  BasicOuterDigitFilter() : _s(0), _NL(0) {}
+
+  void init(Number_t N, Count_t L)
+  {
+    _s  = __builtin_ctzll(N);
+    _NL = 1;
+    for(Count_t i=1; i<L; ++i) {
+      // (lengths whose palindromes don't fit in Value_t aren't filtered)
+      if(__builtin_mul_overflow(_NL,Value_t(N),&_NL)) { _s = 0; }
+    }
+  }
+
+  // false if the filter is off (odd N)
+  bool on() const { return _s != 0; }
+
+  // returns false if none of the palindromes with outer digit a can be binary palindromes
+  bool allowed(Number_t a) const
+  {
+    Number_t r = a & low_mask(_s);
+    if(r%2 == 0) { return false; }
+
+    Value_t lo = a*_NL + a;
+    Value_t hi;
+    if(__builtin_mul_overflow(Value_t(a+1),_NL,&hi)) { return true; }
+    hi -= 1;
+
+    unsigned B = value_bit_length(hi);
+    if(value_bit_length(lo) != B) { return true; }
+    unsigned t = B - value_bit_length(lo ^ hi);   // number of top bits they all share
+    t = std::min(t, std::min(_s, B/2));
+    Number_t prefix = Number_t(hi >> (B-t));
+    return reverse_bits(prefix,t) == (r & low_mask(t));
+  }
+};
+
+template<class Value_t>
+class BasicPairedOps : public BasicOperation<Value_t> {
   // The Paired class handles pairs of operations of the form n:[S,I],S
   //   S may be any operation type.
   //   I is the addition of a single integer value
@@ -171,20 +697,38 @@ class PairedOps : public Operation {
   // The operation resets after completion, ready for another series of invocations.
 
 private:
+  typedef BasicOperation<Value_t>        *OpPtr_t;
+  typedef BasicOuterDigitFilter<Value_t>  Filter_t;
+
   bool     _on_S;  // flag indicating we are still working on completing S
   OpPtr_t  _S;     // pointer to the S operation
-  Number_t _I;     // integer value to add during the I operation
+  Value_t  _I;     // integer value to add during the I operation
+
+  Count_t  _repeat;   // number of times to repeat the [S,I] sub-sequence
+  Count_t  _counter;  // number of times the [S,I] sub-sequence has been done so far
 
-  const Count_t  _repeat;   // number of times to repeat the [S,I] sub-sequence
-  Count_t        _counter;  // number of times the [S,I] sub-sequence has been done so far
+  // outer digits to skip (NULL if none), only ever set on the outermost op (Sk), where
+  //   each [S,I] sub-sequence covers the palindromes of a single outer digit (_counter+1)
+  const Filter_t *_filter;
 
 public:
   // constructor simply set the initial values fo each attribute
-  PairedOps(Count_t n, OpPtr_t S, Number_t I)
-  : _S(S), _I(I), _repeat(n), _counter(0), _on_S(true)
+  BasicPairedOps(Count_t n=0, OpPtr_t S=NULL, Value_t I=0)
+  : _S(S), _I(I), _repeat(n), _counter(0), _on_S(true), _filter(NULL)
   {}
 
-  virtual bool step(Number_t &palindrome)
+  // rebuilds the operation in place (see BasicOperationArena)
+  void init(Count_t n, OpPtr_t S, Value_t I, const Filter_t *filter = NULL)
+  {
+    _on_S    = true;
+    _S       = S;
+    _I       = I;
+    _repeat  = n;
+    _counter = 0;
+    _filter  = filter;
+  }
+
+  virtual bool step(Value_t &palindrome)
   {
     // repeat the [S,I] sub-sequence n times
     if(_counter < _repeat) {
@@ -196,15 +740,12 @@ public:
         }
       } else {
         // S has been completed, add I
-        // but first make sure we won't overflow 64 bits
-        if(palindrome > ULLONG_MAX - _I) {
-          std::cout << "64bit is insufficient" << std::endl;
-          exit(1);
-        }
+        //   (no overflow check, see Increment)
         // add I, increment the [S,I] counter, and reset the _on_S flag
         palindrome += _I;
         _counter += 1;
         _on_S = true;
+        if(_filter && skip_outer(palindrome)) { return false; }
       }
     } else {
       // we've completed the n:[S,I] subsequence
@@ -224,10 +765,98 @@ public:
     //   required to complete the operation
     return true;
   }
+
+  // Skips the [S,I] sub-sequences (outer digits) that the filter rules out, adding all of their
+  //   steps at once.  The palindrome lands on the first palindrome of the next outer digit
+  //   that isn't ruled out.  Returns true if it was the final S that was skipped, in which
+  //   case the palindrome lands on the last palindrome (which has been ruled out) and the
+  //   operation is complete.
+  //  (The outer digit that the generator starts with, 1, is never skipped)
+  bool skip_outer(Value_t &palindrome)
+  {
+    while(!_filter->allowed(_counter+1)) {
+      if(_counter == _repeat) {
+        palindrome += _S->total();
+        _counter = 0;
+        return true;
+      }
+      palindrome += _S->total() + _I;
+      _counter += 1;
+    }
+    return false;
+  }
+
+  // n:[S,I] takes |S|+1 steps per repeat, followed by the |S| steps of the final S
+  virtual Value_t size() const  { return _repeat * (_S->size() + 1) + _S->size(); }
+  virtual Value_t total() const { return _repeat * (_S->total() + _I) + _S->total(); }
+
+  virtual Value_t seek(Value_t k)
+  {
+    // k steps is c complete [S,I] sub-sequences followed by r steps into the next one
+    Value_t nS = _S->size();
+    Value_t c  = k / (nS+1);
+    Value_t r  = k % (nS+1);
+
+    Value_t added = c * (_S->total() + _I);
+    _counter = c;
+    if(r < nS) {
+      // still working on S (for c == _repeat, this is the final S)
+      _on_S  = true;
+      added += _S->seek(r);
+    } else {
+      // S is complete (and has reset itself), I is next
+      _on_S  = false;
+      added += _S->total();
+      _S->seek(0);
+    }
+    return added;
+  }
+};
+
+
+template<class Value_t>
+class BasicOperationArena
+{
+  // Storage for the operations of a Generator, reused from one Generator to the next.
+  //   The sequence of a length is always the same chain of operations (see the Generator
+  //   constructor), only their adders and repeat counts depend on N and L.  So rather than
+  //   allocating (and deleting) a new tree for each (N,L), a Generator rebuilds the tree in
+  //   place, in an arena taken from a per-thread free list.  After the first few bases, the
+  //   sweep doesn't allocate at all and the operations of a sequence sit side by side in memory.
+  // There is a free list (rather than a single arena per thread) as a thread may have more
+  //   than one Generator at a time, e.g. the PerfReplay of a length (see PERF_REPLAY).
+public:
+  BasicIncrement<Value_t>                increment;  // S0 (or the entire sequence for L=2)
+  std::vector< BasicPairedOps<Value_t> > paired;     // S1...Sk
+
+  static BasicOperationArena *acquire()
+  {
+    ArenaList_t &list = free_list();
+    if(list.empty()) { return new BasicOperationArena; }
+    BasicOperationArena *arena = list.back().release();
+    list.pop_back();
+    return arena;
+  }
+
+  static void release(BasicOperationArena *arena)
+  {
+    free_list().emplace_back(arena);
+  }
+
+private:
+  typedef std::vector< std::unique_ptr<BasicOperationArena> > ArenaList_t;
+
+  static ArenaList_t &free_list()
+  {
+    // (the arenas are deleted when the thread exits)
+    thread_local ArenaList_t list;
+    return list;
+  }
 };
 
 
-class Generator : public Operation {
+template<class Value_t>
+class BasicGenerator : public BasicOperation<Value_t> {
   // Generates all of the palindromes with a specified base (N) and length (number of digits).
   // Its final step will generate the first palindrome of length+1.
   // The operation will complete after completing the generation sequence and the first 
@@ -235,16 +864,32 @@ class Generator : public Operation {
   // The operation does not need to reset on completion as it will only be used once
 
 private:
-  bool _done;     // done with sequence, need to add 2 to increase number of digits
-  OpList_t _S;    // list of all S ops needed for the generation operation
-  OpPtr_t  _seq;  // the generation sequence for the current base and length
+  typedef BasicOperation<Value_t>      *OpPtr_t;
+  typedef BasicOperationArena<Value_t>  Arena_t;
+
+  bool _done;       // done with sequence, need to add 2 to increase number of digits
+  Arena_t *_arena;  // storage for all of the S ops needed for the generation operation
+  OpPtr_t  _seq;    // the generation sequence for the current base and length
+
+  Number_t _N;       // the base
+  Count_t  _length;  // number of digits
+  Value_t  _first;   // first palindrome of the length (1000...0001, 11 for L=2)
+
+  BasicOuterDigitFilter<Value_t> _filter;  // (only used if masked, see BasicMaskedGenerator)
 
 public:
+  // the operations don't check their steps for overflow, search_palindromes does it for them
+  static const bool checks_overflow = false;
+
 
   // the Generator constructor wraps all of the operations necessary to generate the palindromes
   //   of the specified length. (See algoithm at end of this file for details.)
-  Generator(Number_t N, Count_t length) : _done(false)
+  //   if masked is set, the outer digits ruled out by BasicOuterDigitFilter are skipped
+  BasicGenerator(Number_t N, Count_t length, bool masked = false) 
+  : _done(false), _arena(Arena_t::acquire()), _N(N), _length(length), _first(Value_t(N)+1)
   {
+    for(Count_t i=2; i<length; ++i) { _first = N*(_first-1) + 1; }
+
     // set the value of k based on the palindrom link
     //   length = 2k+1 (odd) or 2k+2 (even)
     Count_t k = (length+1)/2 - 1;
@@ -256,15 +901,15 @@ public:
     if( length == 2 ) {
       // this one needs to be handled slightly differently as it starts with 22 rather than 11
       // sequence = (q-1):M11
-      _seq = new Increment(q,N+1);
-      _S.push_back(_seq);
+      _arena->increment.init(q,Value_t(N)+1);
+      _seq = &_arena->increment;
     }
     else
     {
       // S0 = 1(odd) or 11(even) followed by k zeros
-      Number_t M = odd ? N : N*(N+1);
+      Value_t M = odd ? Value_t(N) : N*(Value_t(N)+1);
       // I0 = 11 followed by k-1 zeros
-      Number_t I = N+1;
+      Value_t I = Value_t(N)+1;
       // add the k-1 zeros
       for(Count_t i=0; i<k-1; ++i) {
         M *= N;
@@ -272,28 +917,28 @@ public:
       }
 
       // build the sequence (see algorithm at the end of this file)
-      OpPtr_t Si = new Increment(m,M);
-      _S.push_back(Si);
+      //   the ops are rebuilt in place, paired only reallocates when k exceeds all previous k's
+      std::vector< BasicPairedOps<Value_t> > &paired = _arena->paired;
+      paired.resize(k);
+      _arena->increment.init(m,M);
+      OpPtr_t Si = &_arena->increment;
       for(Count_t i=1; i<k; ++i) {
-        Si = new PairedOps(m,Si,I);
-        _S.push_back(Si);
+        paired[i-1].init(m,Si,I);
+        Si = &paired[i-1];
         I /= N;
       }
-      _seq = new PairedOps(q,Si,I);  // Sk
-      _S.push_back(_seq);
+      if(masked) { _filter.init(N,length); }
+      paired[k-1].init(q,Si,I,_filter.on() ? &_filter : NULL);  // Sk
+      _seq = &paired[k-1];
     }
   }
 
-  virtual bool step(Number_t &palindrome)
+  virtual bool step(Value_t &palindrome)
   {
     if(_done) {
       // done generating palindromes of current length (mmm...mmm)
       //   add 2 to go to first palindrom of next length (1000...001)
-      // but only after verifying this won't overflow
-      if(palindrome > ULLONG_MAX - 2) {
-        std::cout << "64bit is insufficient" << std::endl;
-        exit(1);
-      }
+      //   (no overflow check, see Increment)
       palindrome += 2;
 
       // reset (even though it's not necessary) and return false to indicate
@@ -309,121 +954,3346 @@ public:
     return true;
   }
 
-  ~Generator() 
+  // The generator starts on the first palindrome of its length (index 0), each step moves on
+  //   to the next index.  The final step (the +2) moves on to the next length.
+  virtual Value_t size() const  { return _seq->size() + 1; }
+  virtual Value_t total() const { return _seq->total() + 2; }
+
+  virtual Value_t seek(Value_t k)
   {
-    // clean up the list of S operations
-    for(auto op = _S.begin(); op!=_S.end(); ++op) { delete *op; }
+    if(k < _seq->size()) {
+      _done = false;
+      return _seq->seek(k);
+    }
+    // the last palindrome of the current length (mmm...mmm), the +2 is next
+    _done = true;
+    _seq->seek(0);
+    return _seq->total();
   }
-};
 
-class IsBinaryPalindrome
-{
-  // Instances of this class are essentially callable functions
-  //   that detetermine if a given number is a palindrome in base 2.
-  // We take advantage of the fact that we know this will only be called
-  //   with increasing numbers to keep track of the most significant bit (msb)
-  //   so that we don't need to iterate through all bits looking for it on each call.
-  //   We need only check to see if the msb needs to be increased (when it is less than
-  //   the number being tested).
+  // number of palindromes of the current length
+  Value_t count() const { return size(); }
 
-private:
-  Number_t _msb;   // binary number with only the msb set to 1
-  Number_t _mask;  // binary number with only the bits greater than msb set to 1
+  // Moves to the kth palindrome of the current length (k=0 is 1000...0001, or 11 for L=2)
+  //   any subsequent steps continue from there, exactly as if k steps had been taken.
+  //   This allows the search of a single base to be split into independent chunks.
+  void seek(Value_t k, Value_t &palindrome)
+  {
+    palindrome = _first + seek(k);
+  }
 
-public:
-  // constructor initializes the msb and mask to indicate a single bit binary number
-  IsBinaryPalindrome(void) : _msb(1), _mask(~0x1) {}
-  
-  bool operator()(Number_t p) {
-    // no even number can be a binary palindrome (leading 0's not allowed)
-    if(p%2 == 0) { return false; }
-    
-    // The mask contains all the bits greater than the msb.  If p overlaps
-    //  these bits, we have a new msb.  Shift both the msb and the mask by
-    //  one until p no longer overlaps the mask.
-    while(p & _mask) {
-      _mask <<= 1;
-      _msb <<= 1;
-    }
-    
-    // Working from both the msb and lsb, look for differences in the
-    //  bit values.  If any difference are found, not a palindrome
-    //  If we get through all of the bits without finding a difference,
-    //  we have a palindrome.
-    Number_t a = _msb;
-    Number_t b = 1;
-    while(a>b) {
-      Number_t t = a|b;  // palindrome test of the two bits of interest
-      Number_t q = p&t;  // extract just those two bits
-      if((q==0 || q==t)) { // check if both bits are 0 or both bits are 1
-        // if so, shift the current test bits
-        a >>= 1;
-        b <<= 1;
-      } else {
-        // found a difference --> not a palindrome
-        return false;
-      }
-    }
-    // no differences found --> palindrome
-    return true;
+  // Moves to the smallest palindrome of the current length that is not less than lo
+  //   returns false if there isn't one (lo exceeds mmm...mmm)
+  bool seek_bound(Value_t lo, Value_t &palindrome);
+
+  ~BasicGenerator() 
+  {
+    // hand the S operations over to the next Generator
+    Arena_t::release(_arena);
   }
 };
 
-Number_t calc_Pn(Number_t N)
+template<class Value_t>
+class BasicMaskedGenerator : public BasicGenerator<Value_t> {
+  // A Generator that skips the outer digits whose palindromes cannot be binary palindromes
+  //   (see BasicOuterDigitFilter).  For an even N, that's at least half of them.
+  //   Note that the steps are no longer one per palindrome (which seek doesn't account for)
+public:
+  BasicMaskedGenerator(Number_t N, Count_t length) : BasicGenerator<Value_t>(N,length,true) {}
+};
+
+// the 64 bit operations used by all of the (64 bit) engines
+typedef BasicOperation<Number_t> Operation;
+typedef BasicIncrement<Number_t> Increment;
+typedef BasicPairedOps<Number_t> PairedOps;
+typedef BasicGenerator<Number_t> Generator;
+typedef BasicMaskedGenerator<Number_t> MaskedGenerator;
+
+template<class Value_t>
+bool palindrome_index(Number_t N, Count_t L, Value_t lo, Value_t &k)
 {
-  // Need a new IsBinaryPalindrome to reset the most significant bit
-  //   An alternative would be a singleton with a reset method, but
+  // Finds the index (k) of the smallest L digit base-N palindrome that is not less than lo
+  //   (index 0 is 1000...0001, or 11 for L=2).  Returns false if there isn't one.
+  // A palindrome is determined by its top h=ceil(L/2) digits (its prefix) and the palindromes
+  //   are in the same order as their prefixes, so its index is simply prefix - 1000 (h digits).
+  //   The palindrome with the same prefix as lo is either lo or the next palindrome after lo
+  //   if it is not less than lo.  Otherwise, it's the palindrome of the next prefix.
+  Count_t h   = (L+1)/2;
+  Value_t Nlo = 1;  // N^(L-h), the value of the least significant prefix digit
+  Value_t Nh  = 1;  // N^(h-1), the smallest prefix
+  for(Count_t i=0; i<L-h; ++i) { Nlo *= N; }
+  for(Count_t i=1; i<h;   ++i) { Nh  *= N; }
+
+  if(lo <= Nh*Nlo + 1) { k = 0; return true; }
+
+  Value_t prefix = lo / Nlo;
+  if(prefix >= Nh*N) { return false; }
+
+  // mirror the top L-h digits of the prefix into the bottom digits
+  Value_t q   = (L%2) ? prefix/N : prefix;
+  Value_t rev = 0;
+  for(Count_t i=0; i<L-h; ++i, q/=N) { rev = N*rev + q%N; }
+  Value_t p;
+  if(__builtin_add_overflow(prefix*Nlo, rev, &p)) { return false; }
+
+  if(p < lo) {
+    prefix += 1;
+    if(prefix == Nh*N) { return false; }
+  }
+  k = prefix - Nh;
+  return true;
+}
+
+template<class Value_t>
+bool BasicGenerator<Value_t>::seek_bound(Value_t lo, Value_t &palindrome)
+{
+  Value_t k;
+  if(!palindrome_index(_N, _length, lo, k)) { return false; }
+  seek(k, palindrome);
+  return true;
+}
+
+class Odometer {
+  // A flat alternative to the Generator's tree of operations.  It generates the same sequence
+  //   of palindromes (with the same step semantics as Generator), but without any virtual calls.
+  //
+  // The palindrome is tracked by its kernel, stored as a small counter of base-N digits
+  //   with the innermost (middle) digit being the least significant.  Incrementing the counter
+  //   always results in the same change to the palindrome for a given number of digits that
+  //   roll over.  These changes are precomputed for each (N,L) and stored in a delta table:
+  //
+  //     delta[j] = w(j) - m * ( w(0) + w(1) + ... + w(j-1) )
+  //
+  //   where w(i) is the value of a 1 in the ith kernel digit (counting out from the middle)
+  //   and its mirror digit, e.g. for 5 digits:  w(0)=100, w(1)=1010, w(2)=10001.
+  //   The final entry (delta[h], all digits rolled over) is the +2 that takes mmm...mmm
+  //   to the first palindrome of the next length (1000...001).
+  //
+  // Each step is thus a single table lookup and a single addition.  The search for the number
+  //   of digits that rolled over is almost always only one compare (all but 1 in N steps).
+
+protected:
+  Count_t               _h;       // number of digits in the kernel
+  Number_t              _m;       // largest digit in Base-N
+  std::vector<Number_t> _digits;  // kernel digits (innermost first) plus a sentinel digit
+  std::vector<Number_t> _delta;   // delta table (see above)
+  std::vector<Number_t> _span;    // m * ( w(0) + w(1) + ... + w(j-1) ), i.e. mmm - 000 in the inner j digits
+
+public:
+  // advance checks every step for overflow, it's only one compare next to the table lookup
+  static const bool checks_overflow = true;
+
+  Odometer(Number_t N, Count_t length) 
+  : _h((length+1)/2), _m(N-1), _digits(_h+1,0), _delta(_h+1,0), _span(_h+1,0)
+  {
+    // the (low) digit positions of the innermost kernel digit and its mirror
+    //   odd:  both are the middle digit (k)
+    //   even: the two middle digits (k and k+1)
+    Count_t lo = (length-1)/2;
+    Count_t hi = length/2;
+
+    Number_t Nlo = 1;  // N^lo
+    for(Count_t i=0; i<lo; ++i) { Nlo *= N; }
+    Number_t Nhi = (hi == lo) ? Nlo : Nlo * N;  // N^hi
+
+    Number_t sum_w = 0;  // sum of the weights of the inner digits
+    for(Count_t j=0; j<_h; ++j) {
+      // only the middle digit of an odd length palindrome is not paired with a mirror digit
+      Number_t w = (j == 0 && hi == lo) ? Nlo : Nlo + Nhi;
+      _span[j]  = _m * sum_w;
+      _delta[j] = w - _span[j];
+      sum_w += w;
+      Nlo /= N;
+      Nhi *= N;
+    }
+    _delta[_h] = 2;
+
+    reset();
+  }
+
+  bool step(Number_t &palindrome)
+  {
+    return advance(palindrome) < _h;
+  }
+
+  // Fills the batch with (up to) the next n palindromes, returning the number of palindromes
+  //   added to the batch.  This is the same as calling step n times, but with far less overhead.
+  // As with step, palindrome is updated to the last palindrome generated.  If fewer than n
+  //   palindromes are added, the generator is complete and palindrome is the first palindrome
+  //   of the next length (which is NOT added to the batch).
+  Count_t step_batch(Number_t &palindrome, Number_t *batch, Count_t n)
+  {
+    Count_t i = 0;
+    while(i < n) {
+      // run of the innermost digit up to m doesn't need to look for digit rollovers
+      Count_t  run   = std::min(n-i, Count_t(_m - _digits[0]));
+      Number_t delta = _delta[0];
+      Number_t total;
+      if(__builtin_mul_overflow(run,delta,&total) || palindrome > ULLONG_MAX - total) {
+        std::cout << "64bit is insufficient" << std::endl;
+        exit(1);
+      }
+      for(Count_t k=0; k<run; ++k) {
+        palindrome += delta;
+        batch[i++] = palindrome;
+      }
+      _digits[0] += run;
+      if(i == n) { break; }
+
+      // innermost digit is m, the next step rolls over one or more digits
+      if(advance(palindrome) == _h) { break; }
+      batch[i++] = palindrome;
+    }
+    return i;
+  }
+
+  // Moves to the first palindrome with the specified outer digit (a000...000a, or aa for L=2)
+  //   all of the inner digits are set to 0
+  void seek_outer(Number_t a, Number_t &palindrome)
+  {
+    for(auto d = _digits.begin(); d!=_digits.end(); ++d) { *d = 0; }
+    _digits[_h-1] = a;
+    palindrome = a * (_delta[_h-1] + _span[_h-1]); // (i.e. a * w(h-1))
+  }
+
+protected:
+  // steps to the next palindrome and returns the number of kernel digits that rolled over
+  //   (_h indicates that we've moved on to the first palindrome of the next length)
+  Count_t advance(Number_t &palindrome)
+  {
+    // find the number of digits that roll over... the sentinel digit (_digits[_h])
+    //   is never equal to m, so this loop is guaranteed to stop there.
+    Count_t j = 0;
+    while(_digits[j] == _m) { _digits[j++] = 0; }
+    _digits[j] += 1;
+
+    Number_t delta = _delta[j];
+    if(palindrome > ULLONG_MAX - delta) {
+      std::cout << "64bit is insufficient" << std::endl;
+      exit(1);
+    }
+    palindrome += delta;
+
+    if(j == _h) {
+      // just stepped to the first palindrome of the next length
+      //   reset (even though it's not necessary)
+      reset();
+    }
+    return j;
+  }
+
+  void reset()
+  {
+    // all kernel digits are 0 other than the outer digit, which is 1 (1000...0001)
+    //   the 2 digit sequence is the exception, it starts with 11 rather than 22
+    //   (Note that for 2 digit palindromes, the outer digit IS the inner digit.)
+    for(auto d = _digits.begin(); d!=_digits.end(); ++d) { *d = 0; }
+    _digits[_h-1] = 1;
+  }
+};
+
+template<class Value_t>
+class BasicIsBinaryPalindrome
+{
+  // Instances of this class are essentially callable functions
+  //   that detetermine if a given number is a palindrome in base 2.
+  // We take advantage of the fact that we know this will only be called
+  //   with increasing numbers to keep track of the most significant bit (msb)
+  //   so that we don't need to iterate through all bits looking for it on each call.
+  //   We need only check to see if the msb needs to be increased (when it is less than
+  //   the number being tested).
+
+private:
+  Value_t _msb;   // binary number with only the msb set to 1
+  Value_t _mask;  // binary number with only the bits greater than msb set to 1
+
+public:
+  // constructor initializes the msb and mask to indicate a single bit binary number
+  BasicIsBinaryPalindrome(void) : _msb(1), _mask(~Value_t(1)) {}
+  
+  bool operator()(Value_t p) {
+    COUNT_SEARCH(tested,1);
+    // no even number can be a binary palindrome (leading 0's not allowed)
+    if(p%2 == 0) { 
+      COUNT_SEARCH(early_rejects,1);
+      return false; 
+    }
+    
+    // The mask contains all the bits greater than the msb.  If p overlaps
+    //  these bits, we have a new msb.  Shift both the msb and the mask by
+    //  one until p no longer overlaps the mask.
+    while(p & _mask) {
+      _mask <<= 1;
+      _msb <<= 1;
+    }
+    
+    // Working from both the msb and lsb, look for differences in the
+    //  bit values.  If any difference are found, not a palindrome
+    //  If we get through all of the bits without finding a difference,
+    //  we have a palindrome.
+    Value_t a = _msb;
+    Value_t b = 1;
+    while(a>b) {
+      Value_t t = a|b;  // palindrome test of the two bits of interest
+      Value_t q = p&t;  // extract just those two bits
+      if((q==0 || q==t)) { // check if both bits are 0 or both bits are 1
+        // if so, shift the current test bits
+        a >>= 1;
+        b <<= 1;
+      } else {
+        // found a difference --> not a palindrome
+        return false;
+      }
+    }
+    // no differences found --> palindrome
+    COUNT_SEARCH(passed,1);
+    return true;
+  }
+};
+
+typedef BasicIsBinaryPalindrome<Number_t> IsBinaryPalindrome;
+
+template<class Value_t>
+Count_t max_length(Number_t N)
+{
+  // longest palindrome length (L) whose palindromes, and the step beyond them to N^L+1 
+  //   (the first palindrome of length L+1), all fit in Value_t
+  Value_t NL = N;
+  Count_t L  = 1;
+  for(Value_t next_NL; !__builtin_mul_overflow(NL,Value_t(N),&next_NL) && next_NL < Value_t(~Value_t(0)); ++L) { 
+    NL = next_NL; 
+  }
+  return L;
+}
+
+template<class Generator_t, class IsBinaryPalindrome_t, class Value_t>
+__attribute__((noinline))
+Value_t search_checked(Number_t N, Count_t L, Value_t p, IsBinaryPalindrome_t is_binary_palindrome, bool &found)
+{
+  // The search loop of search_palindromes for the palindromes of a length that may overflow
+  //   Value_t.  The palindromes only ever increase, so an overflow shows up as a step to a
+  //   smaller palindrome.
+  // This is kept out of line, with everything that the unchecked loop keeps in registers
+  //   (p and the checker) passed by value, so that it doesn't get in the way of the
+  //   unchecked loop.
+  //   returns the binary palindrome (found), which may be the first palindrome of the next length
+  Generator_t g(N,L);
+  for(Value_t last = p; true; last = p) {
+    bool more = g.step(p);
+    if(p < last) { insufficient_bits<Value_t>(); }
+    found = is_binary_palindrome(p);
+    if(!more || found) { return p; }
+  }
+}
+
+template<class Generator_t, class IsBinaryPalindrome_t, class Value_t>
+Value_t search_palindromes(Number_t N, Count_t L, Value_t p, IsBinaryPalindrome_t &is_binary_palindrome, 
+                           Count_t max_L = ~Count_t(0))
+{
+  // Searches palindromes of length L and up until a binary palindrome is found.
+  //   p must be the first palindrome of length L (11 for L=2) and have already been checked.
+  // Generator_t may be any palindrome generator with the same step semantics as Generator
+  //   (e.g. Generator or Odometer, or BasicGenerator<Wide_t> for Value_t=Wide_t)
+  // IsBinaryPalindrome_t may be IsBinaryPalindrome or FastIsBinaryPalindrome
+  // The search gives up (returning 0) after the palindromes of length max_L, by which point
+  //   p is the first palindrome of length max_L+1, which has been checked.
+  // The Generator's operations don't check for overflow (see Generator_t::checks_overflow).
+  //   Only the lengths whose largest palindrome (N^L-1, or N^L+1 for the step to the next
+  //   length) doesn't fit in Value_t can overflow, so only their steps are checked, for the
+  //   palindrome having wrapped around.
+  PERF_SCOPE(search);
+  const Count_t fit_L = max_length<Value_t>(N);
+  for( ; L<=max_L; ++L) { // (with the default max_L, an infinite loop... we'll return from inside it)
+    PERF_REPLAY(Generator_t,N,L,p);
+    if constexpr (!Generator_t::checks_overflow) {
+      // (not even instantiated for the generators that check themselves, a second copy of
+      //   their step keeps the compiler from inlining it into the unchecked loop)
+      if(L > fit_L) {
+        bool found;
+        p = search_checked<Generator_t>(N, L, p, is_binary_palindrome, found);
+        if(found) { return p; }
+        continue;
+      }
+    }
+    Generator_t g(N,L);
+    while( g.step(p) ) {
+      if(is_binary_palindrome(p)) {
+        return p;
+      }
+    }
+    // The final step of the generator lands on the first palindrome of the next
+    //   length (1000...0001).  This needs to be checked here as the next generator's
+    //   first step moves on to the second palindrome.
+    if(is_binary_palindrome(p)) {
+      return p;
+    }
+  }
+  return 0;
+}
+
+template<class Generator_t, class IsBinaryPalindrome_t = IsBinaryPalindrome>
+Number_t calc_Pn(Number_t N)
+{
+  // Need a new IsBinaryPalindrome to reset the most significant bit
+  //   An alternative would be a singleton with a reset method, but
   //   as this constructor is very light-weight, no need for that
-  IsBinaryPalindrome is_binary_palindrome;
+  IsBinaryPalindrome_t is_binary_palindrome;
   
   // Iterate through increasing number of palindrome digits until
   //   a binary palindrome is found. Start with the two digit
   //   palindrome 22.  We don't actually need to check if this
   //   is a binary palindrome as it is an even number..
-  Number_t p = N+1;
-  for(Count_t L=2; true; ++L) { // yes, an infinte loop... we'll return from inside it
-    Generator g(N,L);
-    while( g.step(p) ) {
-      if(is_binary_palindrome(p)) {
-        return p;
+  return search_palindromes<Generator_t>(N, 2, N+1, is_binary_palindrome);
+}
+
+Number_t inverse_mod_2_64(Number_t u)
+{
+  // multiplicative inverse of an odd number modulo 2^64
+  //   each Newton iteration doubles the number of correct bits (x=u is correct to 3 bits)
+  Number_t x = u;
+  for(int i=0; i<5; ++i) { x *= 2 - u*x; }
+  return x;
+}
+
+class ReverseByteTable
+{
+  // Lookup table of each of the 256 possible bytes with the order of its bits reversed
+private:
+  uint8_t _rev[256];
+public:
+  ReverseByteTable()
+  {
+    for(unsigned b=0; b<256; ++b) {
+      _rev[b] = 0;
+      for(unsigned i=0; i<8; ++i) { _rev[b] |= ((b >> i) & 1) << (7-i); }
+    }
+  }
+  uint8_t operator[](unsigned b) const { return _rev[b]; }
+};
+
+const ReverseByteTable reverse_byte;
+
+class FastIsBinaryPalindrome
+{
+  // A faster (and stateless) alternative to IsBinaryPalindrome
+  //   - the bit length (B) comes directly from a count of the leading zeros
+  //   - early reject: the lowest 16 bits must be the reverse of the highest 16 bits.
+  //     This is two lookups into the reversed byte table and a single compare, and
+  //     it rejects all but roughly 1 in 65536 of the candidates that are not palindromes.
+  //   - the candidates that survive are checked in full by reversing the entire word 
+  //     (see reverse64) and comparing it to the original.
+  // IsBinaryPalindrome is retained as the reference implementation.
+  // Unlike IsBinaryPalindrome, the candidates may be checked in any order.
+
+public:
+  bool operator()(Number_t p) const
+  {
+    COUNT_SEARCH(tested,1);
+    // no even number can be a binary palindrome (leading 0's not allowed)
+    if(p%2 == 0) { 
+      COUNT_SEARCH(early_rejects,1);
+      return false; 
+    }
+
+    unsigned B = 64 - __builtin_clzll(p);
+
+    if(B >= 32) {
+      // the top 16 bits don't overlap with the bottom 16 bits
+      Number_t top = p >> (B-16);
+      Number_t rev = (Number_t(reverse_byte[top & 0xFF]) << 8) | reverse_byte[top >> 8];
+      if(rev != (p & 0xFFFF)) { 
+        COUNT_SEARCH(early_rejects,1);
+        return false; 
       }
     }
+
+    bool rval = (reverse64(p) >> (64-B)) == p;
+    COUNT_SEARCH(passed,rval);
+    return rval;
   }
-  return 0;  // we'll never get here, but to keep the compiler happy
+};
+
+class BatchIsBinaryPalindrome
+{
+  // Tests a batch of candidates at once, returning the index of the first binary palindrome
+  //   in the batch (or the batch size if there are none).
+  //
+  // Rather than comparing the bits pair by pair, each candidate (p) is bit reversed as a whole.
+  //   The reversed value is then shifted right by the number of leading zeros in p, which
+  //   leaves the bits of p in reverse order.  p is a palindrome if this is equal to p.
+  //   Note that this also rejects all even p: the reversed value would end in a 1.
+  //
+  // The vector implementation is chosen at compile time
+  //   AVX-512 (F+BW+CD): 8 candidates per instruction
+  //   AVX2:              4 candidates per instruction
+  //   otherwise:         1 candidate at a time (see reverse64)
+  // In all cases, the bits are reversed within each byte with a nibble lookup table and then
+  //   the bytes are reversed with a byte shuffle ( or bswap).
+
+public:
+  // number of candidates tested by a single call to match_mask
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512CD__)
+  static const Count_t lanes = 8;
+#else
+  static const Count_t lanes = 4;
+#endif
+
+  Count_t operator()(const Number_t *batch, Count_t n) const
+  {
+    Count_t i = first_match(batch,n);
+    COUNT_SEARCH(tested, (i<n) ? i+1 : n);
+    COUNT_SEARCH(passed, i<n);
+    return i;
+  }
+
+  // tests the lanes candidates v[0..lanes), bit i of the result is set if v[i] is a palindrome
+  unsigned match_mask(const Number_t *v) const
+  {
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512CD__)
+    const __m512i lut_lo = _mm512_broadcast_i32x4(_mm_setr_epi8(
+      0x0,0x8,0x4,0xC,0x2,0xA,0x6,0xE,0x1,0x9,0x5,0xD,0x3,0xB,0x7,0xF));
+    const __m512i lut_hi = _mm512_slli_epi64(lut_lo,4);
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    const __m512i bswap  = _mm512_broadcast_i32x4(_mm_setr_epi8(
+      7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8));
+    __m512i p   = _mm512_loadu_si512(v);
+    __m512i lo  = _mm512_and_si512(p,nibble);
+    __m512i hi  = _mm512_and_si512(_mm512_srli_epi64(p,4),nibble);
+    __m512i rev = _mm512_or_si512(_mm512_shuffle_epi8(lut_hi,lo), _mm512_shuffle_epi8(lut_lo,hi));
+    rev = _mm512_shuffle_epi8(rev,bswap);
+    rev = _mm512_srlv_epi64(rev,_mm512_lzcnt_epi64(p));
+    return _mm512_cmpeq_epi64_mask(rev,p);
+#elif defined(__AVX2__)
+    const __m256i lut_lo = _mm256_setr_epi8(
+      0x0,0x8,0x4,0xC,0x2,0xA,0x6,0xE,0x1,0x9,0x5,0xD,0x3,0xB,0x7,0xF,
+      0x0,0x8,0x4,0xC,0x2,0xA,0x6,0xE,0x1,0x9,0x5,0xD,0x3,0xB,0x7,0xF);
+    const __m256i lut_hi = _mm256_slli_epi64(lut_lo,4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i bswap  = _mm256_setr_epi8(
+      7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8,
+      7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+    __m256i p   = _mm256_loadu_si256((const __m256i *)v);
+    __m256i lo  = _mm256_and_si256(p,nibble);
+    __m256i hi  = _mm256_and_si256(_mm256_srli_epi64(p,4),nibble);
+    __m256i rev = _mm256_or_si256(_mm256_shuffle_epi8(lut_hi,lo), _mm256_shuffle_epi8(lut_lo,hi));
+    rev = _mm256_shuffle_epi8(rev,bswap);
+    // AVX2 has no 64 bit leading zero count... but it's cheap to do these one at a time
+    __m256i lz  = _mm256_setr_epi64x(__builtin_clzll(v[0]), __builtin_clzll(v[1]),
+                                     __builtin_clzll(v[2]), __builtin_clzll(v[3]));
+    rev = _mm256_srlv_epi64(rev,lz);
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(rev,p)));
+#else
+    unsigned rval = 0;
+    for(Count_t i=0; i<lanes; ++i) {
+      rval |= unsigned( (reverse64(v[i]) >> __builtin_clzll(v[i])) == v[i] ) << i;
+    }
+    return rval;
+#endif
+  }
+
+private:
+  Count_t first_match(const Number_t *batch, Count_t n) const
+  {
+    Count_t i = 0;
+#if (defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512CD__)) || defined(__AVX2__)
+    for( ; i+lanes<=n; i+=lanes) {
+      unsigned match = match_mask(batch+i);
+      if(match) { return i + __builtin_ctz(match); }
+    }
+#endif
+    // scalar fallback (and any candidates left over from the vector loop)
+    for( ; i<n; ++i) {
+      Number_t p = batch[i];
+      if( (reverse64(p) >> __builtin_clzll(p)) == p ) { return i; }
+    }
+    return n;
+  }
+};
+
+class PruningOdometer : public Odometer {
+  // An Odometer that skips over entire blocks of palindromes that cannot contain a binary palindrome.
+  //
+  // Each time an outer kernel digit is incremented (j>0 inner digits roll over), the palindrome
+  //   lands on the first of a block of palindromes which share the same h-j outer digits
+  //   (and their mirrors).  All palindromes in the block lie in [lo,hi], where lo is the
+  //   current palindrome and hi = lo + span(j) (all j inner digits = m).
+  //   - If lo and hi share their top t bits, any binary palindrome in the block must end
+  //     with those t bits reversed.
+  //   - The inner digits are all multiples of N^(h-j).  If N = 2^s * u (u odd), the last
+  //     s*(h-j) bits are therefore the same for every palindrome in the block.
+  //   If these fixed low bits don't match the reversed top bits, the entire block is skipped.
+  // Note that this only applies to even N.  For odd N (s=0), none of the low bits are fixed.
+
+private:
+  unsigned _s;  // power of 2 in N
+
+public:
+  PruningOdometer(Number_t N, Count_t length) : Odometer(N,length), _s(__builtin_ctzll(N))
+  {}
+
+  bool step(Number_t &palindrome)
+  {
+    // j=0 indicates that only the innermost digit changed (still in the same block)
+    //   the start of a new block is rare enough to be handled out of line
+    Count_t j = advance(palindrome);
+    return (j == 0) || new_block(palindrome,j);
+  }
+
+private:
+  // skips all blocks (starting with the current one) that cannot contain a binary palindrome
+  //   returns false if this moves on to the first palindrome of the next length
+  bool new_block(Number_t &palindrome, Count_t j)
+  {
+    while( j > 0 && j < _h && _s > 0 && cannot_match(palindrome,j) ) {
+      // skip to the end of the block: set all of the inner digits to m
+      for(Count_t i=0; i<j; ++i) { _digits[i] = _m; }
+      palindrome += _span[j];
+      j = advance(palindrome);
+    }
+    return j < _h;
+  }
+
+  // returns true if none of the palindromes in the block starting at lo with j inner digits
+  //   can be a binary palindrome (see above)
+  bool cannot_match(Number_t lo, Count_t j) const
+  {
+    if(lo > ULLONG_MAX - _span[j]) { return false; } // let advance deal with the overflow
+    Number_t hi = lo + _span[j];
+
+    unsigned B = bit_length(lo);
+    if(bit_length(hi) != B) { return false; }
+
+    unsigned t = B - bit_length(lo ^ hi);  // number of shared top bits
+    t = std::min(t, unsigned(_s*(_h-j)));
+    t = std::min(t, B/2);
+    if(t == 0) { return false; }
+
+    return reverse_bits(lo >> (B-t), t) != (lo & low_mask(t));
+  }
+};
+
+Number_t search_progression(Number_t c, Number_t w, Number_t bmax, FastIsBinaryPalindrome &is_binary_palindrome)
+{
+  // Searches the arithmetic progression p = c + b*w (for b = 0, 1, ... bmax) for the smallest
+  //   binary palindrome (returns 0 if there isn't one).
+  //
+  // This is the innermost loop for any palindrome length once all other kernel digits
+  //   are fixed. e.g.  3 digits: (a)(b)(a)    = a(N^2+1) + b(N)       c=a(N^2+1), w=N
+  //                    4 digits: (a)(b)(b)(a) = a(N^3+1) + b(N^2+N)   c=a(N^3+1), w=N^2+N
+  //
+  // Rather than testing every b, we take advantage of the fact that the top t bits of a B bit
+  //   binary palindrome determine its bottom t bits (as long as t <= B/2):
+  //   - split the range of p values into blocks of 2^(B-t) values P|xxx...x, where P is
+  //     a fixed t bit prefix.  Every binary palindrome in this block ends in reverse(P).
+  //   - solve c + b*w = reverse(P)  (mod 2^t) for b:
+  //       let w = 2^s * u (u odd), d = reverse(P) - c
+  //       - if d is not a multiple of 2^min(s,t), no p in this block can be a palindrome
+  //       - otherwise, b = (d/2^s) * u^-1 (mod 2^(t-s))
+  //   - only b values with this residue need to be tested, i.e. every 2^(t-s)th b
+  //
+  // The choice of t balances the number of blocks against the number of b values tested
+  //   within each block:  #blocks ~ R/2^(B-t),  #tests ~ R*2^s/(w*2^t)  (R = range of p)
+  //   These are equal when 2^(2t) = 2^(B+s)/w
+
+  // not worth the overhead for short progressions (i.e. small bases)
+  if(bmax < 64) {
+    for(Number_t b=0, p=c; b<=bmax; ++b, p+=w) {
+      if(is_binary_palindrome(p)) { return p; }
+    }
+    return 0;
+  }
+
+  Number_t lo = c;
+  Number_t hi = c + bmax*w;
+
+  unsigned s    = __builtin_ctzll(w);
+  Number_t uinv = inverse_mod_2_64(w>>s);
+  unsigned wlen = bit_length(w);
+
+  // binary palindromes are examined one bit length (B) at a time
+  for(unsigned B = bit_length(lo); B <= bit_length(hi); ++B) {
+    Number_t Blo = std::max(lo, Number_t(1) << (B-1));
+    Number_t Bhi = std::min(hi, low_mask(B));
+
+    // choose prefix length (t), see above
+    int t = (int(B) + int(s) - int(wlen) + 1)/2;
+    t = std::max(0, std::min(t, int(B/2)));
+
+    unsigned shift = B - t;                  // number of bits following the prefix
+    unsigned k     = (t > int(s)) ? t-s : 0; // number of bits in the b residue
+    Number_t dmask = low_mask(std::min(int(s),t));
+    Number_t bstep = Number_t(1) << k;
+
+    Number_t P0 = (t == 0) ? 0 : Blo >> shift;
+    Number_t P1 = (t == 0) ? 0 : Bhi >> shift;
+
+    // reverse of (the t bits of) P, updated incrementally as P increases
+    Number_t rev = reverse_bits(P0,t);
+
+    for(Number_t P = P0; P <= P1; ++P) {
+      Number_t d = rev - c;
+      if((d & dmask) == 0) {
+        // range of p values (and thus b values) in this block
+        Number_t plo = std::max(Blo, (t == 0) ? 0 : P << shift);
+        Number_t phi = std::min(Bhi, (t == 0) ? ~Number_t(0) : (P << shift) | low_mask(shift));
+        Number_t b0  = (plo - c + w - 1)/w;
+        Number_t b1  = (phi - c)/w;
+
+        // first b >= b0 with the required residue
+        Number_t br = ((d>>s) * uinv) & (bstep-1);
+        for(Number_t b = b0 + ((br - b0) & (bstep-1)); b <= b1; b += bstep) {
+          Number_t p = c + b*w;
+          if(is_binary_palindrome(p)) { return p; }
+        }
+      }
+
+      // a zero length prefix has a single (empty) block
+      if(t == 0) { break; }
+
+      // increment the reversed prefix: clear the leading 1s, then set the next 0
+      Number_t bit = Number_t(1) << (t-1);
+      while(rev & bit) { rev ^= bit; bit >>= 1; }
+      rev |= bit;
+    }
+  }
+  return 0;
 }
 
+class RowOdometer : public Odometer {
+  // An Odometer that steps a whole row of palindromes at a time, a row being the N palindromes
+  //   that only differ in their innermost kernel digit: the progression c + b*w(0) (b=0..m),
+  //   where c is the first palindrome of the row.  Each row is left to search_progression.
+  // The rows of a length are indexed in increasing order of palindrome, so a length can be
+  //   split into chunks of rows, each started with seek_row (see HybridScheduler).
+  //   Row r has the outer kernel digits of (N^(h-2) + r), in base-N, outer digit first.
+  // Only used for 5 or more digits (3 or more kernel digits).
 
-int main(int argc, const char * argv[])
+private:
+  Count_t _length;
+
+public:
+  RowOdometer(Number_t N, Count_t length) : Odometer(N,length), _length(length)
+  {}
+
+  // number of rows of the length, m*N^(h-2)
+  Number_t rows() const
+  {
+    Number_t n = _m;
+    for(Count_t j=2; j<_h; ++j) { n *= _m+1; }
+    return n;
+  }
+
+  // weight of the innermost kernel digit (and its mirror), i.e. the step within a row
+  Number_t inner_weight() const { return weight(0); }
+
+  // row of the palindrome p (of the length), its top h-1 digits are the outer kernel digits
+  Number_t row_of(Number_t p) const
+  {
+    for(Count_t j=_h-1; j<_length; ++j) { p /= _m+1; }
+    Number_t first = 1;  // N^(h-2), the outer kernel digits of row 0
+    for(Count_t j=2; j<_h; ++j) { first *= _m+1; }
+    return p - first;
+  }
+
+  // Moves to row r, c is its first palindrome (innermost kernel digit 0)
+  void seek_row(Number_t r, Number_t &c)
+  {
+    c = 0;
+    _digits[0] = 0;
+    for(Count_t j=1; j<_h; ++j) {
+      _digits[j] = (j+1 < _h) ? r % (_m+1) : r + 1;
+      r /= _m+1;
+      c += _digits[j] * weight(j);
+    }
+  }
+
+  // Moves on to the next row (there must be one)
+  void step_row(Number_t &c)
+  {
+    Count_t j = 1;
+    while(_digits[j] == _m) { 
+      _digits[j] = 0; 
+      c -= _m * weight(j++);
+    }
+    _digits[j] += 1;
+    c += weight(j);
+  }
+
+private:
+  // w(j), see Odometer
+  Number_t weight(Count_t j) const { return _delta[j] + _span[j]; }
+};
+
+template<unsigned L, bool Progression=false>
+class FixedLength
 {
-  time_t start_time = std::time(NULL);
-  Number_t max_pn = 0;
-  Number_t tgt_pn = 1000000000000000; // 1 quadrillion
-
-  // Examine increaseing bases (N) util P(N) exceeds 1 quadrillion
-  //   The upper bound in this for loop is purely to avoid an infitinite-loop.
-  //   It is expected that the loop will be exited LONG before hitting this.
-  for(Number_t N=3; N<tgt_pn; ++N)
-  {
-    Number_t pn = calc_Pn(N);
-    if(pn > max_pn) {
-      // only report P(N) values that are larger than the last P(N) value in the 
-      //   solution sequence.
-      std::cout 
-        << hh_mm_ss(std::time(NULL) - start_time) << "  "
-        << N << ": "
-        << add_commas(pn) << ": "
-        << base_n_str(pn,N) << " "
-        << base_n_str(pn,2)
-        << std::endl;
-      
-      max_pn = pn;
+  // Searches all of the palindromes of a fixed (small) length, L, for a binary palindrome.
+  // Rather than stepping through a general purpose generator, the palindromes are generated
+  //   by H=(L+1)/2 nested loops, one for each kernel digit.  The loops are generated at
+  //   compile time (via scan<D>), so there is no bookkeeping of which digit is being updated.
+  //   Each loop simply adds the weight of its digit (and its mirror) on each iteration.
+  //     e.g. for L=5:  10001 (outer digit), 1010, 100 (middle digit)
+  // The palindromes are visited in increasing order, starting with 1000...0001 (or 22 for L=2)
+  // If Progression is set, the innermost loop is replaced by search_progression, which only
+  //   tests the values of the middle digit(s) that can result in a binary palindrome.
 
-      if(pn >= tgt_pn) {
-        // if P(N) exceeds 1 quadrillion, we're done... break out of the loop
-        break;
+private:
+  static const unsigned H = (L+1)/2;  // number of kernel digits
+
+  Number_t _N;     // the base
+  Number_t _w[H];  // weight of each kernel digit, outer digit first
+
+public:
+  FixedLength(Number_t N) : _N(N)
+  {
+    Number_t lo = 1;  // N^D
+    Number_t hi = 1;  // N^(L-1-D)
+    for(unsigned i=1; i<L; ++i) { hi *= N; }
+    for(unsigned D=0; D<H; ++D) {
+      _w[D] = (lo == hi) ? lo : lo + hi;  // the middle digit of an odd length has no mirror
+      lo *= N;
+      hi /= N;
+    }
+  }
+
+  // returns the smallest binary palindrome of length L (or 0 if there isn't one)
+  Number_t search(FastIsBinaryPalindrome &is_binary_palindrome) const
+  {
+    // smallest palindrome exceeding 2N is 22 (see calc_Pn)
+    Number_t first = (L == 2) ? 2 : 1;
+    return scan<0>(first, first*_w[0], is_binary_palindrome);
+  }
+
+private:
+  template<unsigned D>
+  Number_t scan(Number_t d, Number_t p, FastIsBinaryPalindrome &is_binary_palindrome) const
+  {
+    // loop over all values of digit D (starting at d) with all digits beyond D set to 0
+    for( ; d<_N; ++d, p+=_w[D] ) {
+      if constexpr (D+1 == H && Progression) {
+        return search_progression(p, _w[D], _N-1-d, is_binary_palindrome);
+      } else if constexpr (D+1 == H) {
+        if(is_binary_palindrome(p)) { return p; }
+      } else {
+        Number_t rval = scan<D+1>(0, p, is_binary_palindrome);
+        if(rval) { return rval; }
+      }
+    }
+    return 0;
+  }
+};
+
+template<unsigned L, bool Progression=false>
+Number_t search_fixed_length(Number_t N, FastIsBinaryPalindrome &is_binary_palindrome)
+{
+  return FixedLength<L,Progression>(N).search(is_binary_palindrome);
+}
+
+// jump table of the fixed length searches, indexed by palindrome length
+typedef Number_t (*LengthSearch_t)(Number_t N, FastIsBinaryPalindrome &is_binary_palindrome);
+
+const LengthSearch_t fixed_length_search[] = {
+  NULL, NULL,  // there are no 0 or 1 digit palindromes exceeding 2N
+  search_fixed_length<2>,
+  search_fixed_length<3>,
+  search_fixed_length<4>,
+  search_fixed_length<5>,
+  search_fixed_length<6>,
+};
+const Count_t max_fixed_length = sizeof(fixed_length_search)/sizeof(LengthSearch_t) - 1;
+
+// same as fixed_length_search, but using search_progression for 3 and 4 digit palindromes
+const LengthSearch_t progression_length_search[] = {
+  NULL, NULL,
+  search_fixed_length<2>,
+  search_fixed_length<3,true>,
+  search_fixed_length<4,true>,
+  search_fixed_length<5>,
+  search_fixed_length<6>,
+};
+
+Number_t calc_Pn_lengths(Number_t N, const LengthSearch_t *length_search, Count_t max_L = ~Count_t(0))
+{
+  // Same as calc_Pn, but with short palindromes searched by a table of fixed length searches.
+  //   Only palindromes longer than max_fixed_length (or those that might not fit in
+  //   64 bits) are handed off to the PruningOdometer.
+  // Gives up (returning 0) after the palindromes of length max_L (see search_palindromes)
+  FastIsBinaryPalindrome is_binary_palindrome;
+
+  Number_t NL = N;  // N^(L-1), the smallest length L palindrome is NL+1
+  Count_t  L  = 2;
+  for( ; L<=max_fixed_length && L<=max_L; ++L) {
+    // the largest length L palindrome is N^L-1, make sure it fits in 64 bits
+    Number_t next_NL;
+    if(__builtin_mul_overflow(NL,N,&next_NL)) { break; }
+
+    Number_t p = length_search[L](N,is_binary_palindrome);
+    if(p) { return p; }
+
+    NL = next_NL;
+  }
+
+  // continue with the first palindrome of length L (1000...0001)
+  Number_t p = NL + 1;
+  if(is_binary_palindrome(p)) { return p; }
+  return search_palindromes<PruningOdometer>(N, L, p, is_binary_palindrome, max_L);
+}
+
+Number_t calc_Pn_fixed(Number_t N)
+{
+  return calc_Pn_lengths(N, fixed_length_search);
+}
+
+Number_t calc_Pn_progression(Number_t N)
+{
+  return calc_Pn_lengths(N, progression_length_search);
+}
+
+Wide_t search_wide(Number_t N, Count_t L64)
+{
+  // Continues the search (in 128 bits) once all of the palindromes of up to L64 digits, the
+  //   longest that fit in 64 bits, have been searched, starting with the first palindrome of
+  //   length L64+1 (its check was the last 64 bit one)
+  Wide_t p = 1;
+  for(Count_t i=0; i<L64; ++i) { p *= N; }
+  p += 1;
+  //   (with the outer digits that can't give a binary palindrome skipped, see BasicOuterDigitFilter)
+  BasicIsBinaryPalindrome<Wide_t> is_binary_palindrome;
+  return search_palindromes< BasicMaskedGenerator<Wide_t> >(N, L64+1, p, is_binary_palindrome);
+}
+
+Wide_t calc_Pn_wide(Number_t N)
+{
+  // Same as calc_Pn_progression for as long as the palindromes fit in 64 bits, after which
+  //   the search continues (in 128 bits) with a BasicGenerator<Wide_t>.  The 128 bit search
+  //   is only ever needed by the bases whose P(N) doesn't fit in 64 bits, every other base
+  //   runs entirely in the 64 bit engine.
+  Count_t  L64 = max_length<Number_t>(N);
+  Number_t pn  = calc_Pn_lengths(N, progression_length_search, L64);
+  if(pn) { return pn; }
+  return search_wide(N, L64);
+}
+
+Number_t calc_Pn_batch(Number_t N)
+{
+  // Same as calc_Pn<Odometer>, but with the candidates generated and checked in batches
+  const Count_t batch_size = 256;
+  Number_t batch[batch_size];
+
+  BatchIsBinaryPalindrome is_binary_palindrome;
+
+  Number_t p = N+1;
+  for(Count_t L=2; true; ++L) { // yes, an infinte loop... we'll return from inside it
+    Odometer g(N,L);
+    Count_t n;
+    do {
+      n = g.step_batch(p, batch, batch_size);
+      Count_t i = is_binary_palindrome(batch, n);
+      if(i < n) { return batch[i]; }
+    } while(n == batch_size);
+
+    // first palindrome of the next length (see search_palindromes)
+    if(is_binary_palindrome(&p,1) == 0) { return p; }
+  }
+  return 0;  // we'll never get here, but to keep the compiler happy
+}
+
+Number_t calc_Pn_seek(Number_t N)
+{
+  // Same search as calc_Pn<Generator>, but with each length split into independent chunks
+  //   of seek_chunk palindromes, each with its own Generator positioned by seek.  This is
+  //   how the search of a single base can be handed out to multiple threads (or nodes).
+  //   Here, the chunks are simply searched in order, which mostly serves to verify seek.
+  const Count_t seek_chunk = 1000;
+
+  FastIsBinaryPalindrome is_binary_palindrome;
+
+  Number_t NL = N;  // N^(L-1)
+  Count_t  L  = 2;
+  for( ; true; ++L) {
+    // the largest length L palindrome is N^L-1, make sure it fits in 64 bits
+    Number_t next_NL;
+    if(__builtin_mul_overflow(NL,N,&next_NL)) { break; }
+
+    // start with the smallest palindrome exceeding 2N (22 for L=2)
+    Count_t k0;
+    palindrome_index(N, L, 2*N+1, k0);
+
+    Count_t count = Generator(N,L).count();
+    for(Count_t k = k0; k < count; k += seek_chunk) {
+      Generator g(N,L);
+      Number_t  p;
+      g.seek(k,p);
+      Count_t n = std::min(seek_chunk, count-k);
+      for(Count_t i=1; true; ++i) {
+        if(is_binary_palindrome(p)) { return p; }
+        if(i == n) { break; }
+        g.step(p);
+      }
+    }
+
+    NL = next_NL;
+  }
+
+  // continue with the first palindrome of length L (1000...0001), see calc_Pn_lengths
+  Number_t p = NL + 1;
+  if(is_binary_palindrome(p)) { return p; }
+  return search_palindromes<Generator>(N, L, p, is_binary_palindrome);
+}
+
+class IsBaseNPalindrome
+{
+  // Instances of this class are essentially callable functions
+  //   that detetermine if a given number is a palindrome in base N.
+  // Rather than converting the entire number to base N, the trailing digits are peeled off
+  //   and accumulated (in reverse order) until the reversed value catches up with what
+  //   remains of the number.  At that point we have two halves that must match (for odd
+  //   lengths, the reversed half also includes the middle digit).  As neither half is ever
+  //   more than half of the digits, there is no risk of overflowing 64 bits.
+
+private:
+  Number_t _N;
+
+public:
+  IsBaseNPalindrome(Number_t N) : _N(N) {}
+
+  bool operator()(Number_t p) const
+  {
+    COUNT_SEARCH(tested,1);
+    // no trailing 0s (leading 0's not allowed)
+    if(p%_N == 0) { 
+      COUNT_SEARCH(early_rejects,1);
+      return false; 
+    }
+
+    Number_t rev = 0;
+    while(rev < p) {
+      rev = _N*rev + p%_N;
+      p /= _N;
+    }
+    bool rval = (p == rev) || (p == rev/_N);
+    COUNT_SEARCH(passed,rval);
+    return rval;
+  }
+};
+
+class FastIsBaseNPalindrome
+{
+  // A faster alternative to IsBaseNPalindrome that avoids hardware division entirely.
+  //   - all of the powers of N that fit in 64 bits are precomputed, along with a Divider
+  //     for each, when the instance is created (once per base)
+  //   - the number of base-N digits (L) comes from the table of powers of N
+  //   - the leading and trailing digits are then compared without converting the rest of
+  //     the number.  If they match, both are removed and we repeat with the next pair.
+  //       leading  = p / N^(L-1)
+  //       trailing = p % N
+  //   This exits on the first mismatch, which for all but 1 in N candidates is the first pair.
+
+private:
+  std::vector<Number_t> _pow;  // N^i
+  std::vector<Divider>  _div;  // Divider for each N^i
+
+public:
+  FastIsBaseNPalindrome(Number_t N)
+  {
+    Number_t Ni = 1;
+    while(true) {
+      _pow.push_back(Ni);
+      _div.push_back(Divider(Ni));
+      if(__builtin_mul_overflow(Ni,N,&Ni)) { break; }
+    }
+  }
+
+  bool operator()(Number_t p) const
+  {
+    COUNT_SEARCH(tested,1);
+    // number of digits in p
+    size_t L = 1;
+    while(L < _pow.size() && _pow[L] <= p) { ++L; }
+
+    const Divider &divN = _div[1];
+    while(L > 1) {
+      Number_t lead  = _div[L-1].divmod(p);  // p is now all but the leading digit
+      Number_t inner = divN.divmod(p);       // p is now the trailing digit
+      if(lead != p) { return false; }
+      p  = inner;
+      L -= 2;
+      // inner is missing the leading digit, but any leading 0's in inner are required
+      //   to match the trailing 0's of inner.  We don't need to recompute L.
+    }
+    COUNT_SEARCH(passed,1);
+    return true;
+  }
+};
+
+struct BinaryPalindromeIndexHeader
+{
+  // start of a binary palindrome index file (see BinaryPalindromeIndex)
+  char     magic[8];    // "BPINDEX1"
+  uint64_t max_bits;    // the index holds all of the binary palindromes of up to max_bits bits
+  uint64_t offset[66];  // offset[B]: position of the first palindrome of B bits (B in [1,max_bits+1]),
+                        //   where offset[max_bits+1] is the number of palindromes in the index
+};
+
+static const char binary_palindrome_index_magic[8] = {'B','P','I','N','D','E','X','1'};
+
+class BinaryPalindromeIndex
+{
+  // Read only view of a file of all of the binary palindromes of up to max_bits bits, in
+  //   increasing order, as built by build_binary_palindrome_index (--build-index).
+  // The file is mapped into memory, so a sweep that uses it (--index) only pages in the
+  //   palindromes it actually looks at, as sequential reads, instead of generating them.
+  //   BinaryPalindromes picks up the index (if one has been loaded) on its own, so all of the
+  //   binary first engines (binary, fastbinary, adaptive, sieve) read from it.
+  // There are 2^(ceil(B/2)-1) palindromes of B bits, i.e. about 2^(max_bits/2+1) in all
+  //   (2^26 or 512MB for 50 bits).  The palindromes are grouped by bit length, a search for
+  //   the first palindrome not less than lo is a binary search within its bit length.
+
+private:
+  int                                _fd;
+  void                              *_data;    // the mapped file
+  size_t                             _size;
+  const BinaryPalindromeIndexHeader *_header;  // NULL if the file isn't an index
+  const Number_t                    *_palindromes;
+
+  static BinaryPalindromeIndex *_loaded;
+
+public:
+  BinaryPalindromeIndex(const std::string &path)
+  : _fd(open(path.c_str(), O_RDONLY)), _data(MAP_FAILED), _size(0), _header(NULL), _palindromes(NULL)
+  {
+    struct stat st;
+    if(_fd < 0 || fstat(_fd, &st) != 0 || size_t(st.st_size) < sizeof(BinaryPalindromeIndexHeader)) { return; }
+    _size = st.st_size;
+    _data = mmap(NULL, _size, PROT_READ, MAP_SHARED, _fd, 0);
+    if(_data == MAP_FAILED) { return; }
+
+    const BinaryPalindromeIndexHeader *header = static_cast<const BinaryPalindromeIndexHeader *>(_data);
+    if( std::memcmp(header->magic, binary_palindrome_index_magic, sizeof(header->magic)) != 0
+        || header->max_bits < 1 || header->max_bits > 64
+        || _size < sizeof(*header) + header->offset[header->max_bits+1] * sizeof(Number_t) ) { return; }
+    _header      = header;
+    _palindromes = reinterpret_cast<const Number_t *>(header + 1);
+  }
+
+  ~BinaryPalindromeIndex()
+  {
+    if(_data != MAP_FAILED) { munmap(_data, _size); }
+    if(_fd >= 0) { ::close(_fd); }
+  }
+
+  bool ok() const { return _header != NULL; }
+
+  // Loads the index used by all BinaryPalindromes from here on (see --index)
+  //   returns false if the file isn't an index
+  static bool load(const std::string &path)
+  {
+    std::unique_ptr<BinaryPalindromeIndex> index(new BinaryPalindromeIndex(path));
+    if(!index->ok()) { return false; }
+    delete _loaded;
+    _loaded = index.release();
+    return true;
+  }
+
+  // the loaded index (NULL if there isn't one)
+  static const BinaryPalindromeIndex *loaded() { return _loaded; }
+
+  // returns true if the index holds the smallest binary palindrome not less than lo
+  bool covers(Number_t lo) const { return lo > 0 && bit_length(lo) <= _header->max_bits; }
+
+  // first palindrome not less than lo (which the index must cover)
+  const Number_t *lower_bound(Number_t lo) const
+  {
+    unsigned B = bit_length(lo);
+    return std::lower_bound(_palindromes + _header->offset[B], _palindromes + _header->offset[B+1], lo);
+  }
+
+  const Number_t *end() const { return _palindromes + _header->offset[_header->max_bits+1]; }
+};
+
+BinaryPalindromeIndex *BinaryPalindromeIndex::_loaded = NULL;
+
+class BinaryPalindromes
+{
+  // Generates binary palindromes in increasing order (think python generator)
+  //   A binary palindrome with B bits is determined by its top h=ceil(B/2) bits (the kernel),
+  //   the bottom B/2 bits are the top B/2 bits reversed.  Incrementing the kernel (k) steps
+  //   to the next binary palindrome.  Once all h bits of the kernel are 1, we move on to B+1 bits.
+  //
+  //    B=5:  k=100 -> 10001,  k=101 -> 10101,  k=110 -> 11011,  k=111 -> 11111
+  //    B=6:  k=100 -> 100001, k=101 -> 101101, ...
+  //
+  // If an index has been loaded (see BinaryPalindromeIndex), the palindromes are read from
+  //   the index instead, for as long as it lasts, and generated from there on.
+
+private:
+  unsigned _B;  // bit length of the current palindrome
+  Number_t _k;  // kernel of the current palindrome (top ceil(B/2) bits)
+  Number_t _value;  // the current palindrome
+
+  const Number_t *_p;    // the current palindrome in the index (NULL once past the index)
+  const Number_t *_end;  // end of the index
+
+public:
+  // starts with the smallest binary palindrome that is not less than lo
+  BinaryPalindromes(Number_t lo) : _B(bit_length(lo)), _k(lo >> (_B/2)), _p(NULL), _end(NULL)
+  {
+    const BinaryPalindromeIndex *index = BinaryPalindromeIndex::loaded();
+    if(index && index->covers(lo)) {
+      _p   = index->lower_bound(lo);
+      _end = index->end();
+      if(_p != _end) { _value = *_p; return; }
+      // (nothing in the index, i.e. lo is beyond its last palindrome, but with as many bits)
+      _p = NULL;
+    }
+    if(lo <= 1) { _B = 1; _k = 1; }
+    _value = generate();
+    if(_value < lo) { next(); }
+  }
+
+  // returns false once we've run out of 64 bit palindromes
+  bool valid() const { return _B <= 64; }
+
+  Number_t value() const { return _value; }
+
+  void next()
+  {
+    if(_p) {
+      if(++_p != _end) { _value = *_p; return; }
+      // past the end of the index, continue by generating from its last palindrome
+      _p = NULL;
+      _B = bit_length(_value);
+      _k = _value >> (_B/2);
+    }
+    _k += 1;
+    if(_k >> ((_B+1)/2)) {
+      // kernel overflowed, move on to the first palindrome with one more bit
+      _B += 1;
+      _k = Number_t(1) << ((_B-1)/2);
+    }
+    _value = generate();
+  }
+
+private:
+  Number_t generate() const
+  {
+    return (_k << (_B/2)) | reverse_bits(_k >> (_B%2), _B/2);
+  }
+};
+
+void build_binary_palindrome_index(const std::string &path, unsigned max_bits)
+{
+  // Writes all of the binary palindromes of up to max_bits bits to an index file (see
+  //   BinaryPalindromeIndex), buffered and written flush_size palindromes at a time
+  const size_t flush_size = 1<<16;
+
+  BinaryPalindromeIndexHeader header = {};
+  std::memcpy(header.magic, binary_palindrome_index_magic, sizeof(header.magic));
+  header.max_bits  = max_bits;
+  header.offset[1] = 0;
+  for(unsigned B=1; B<=max_bits; ++B) {
+    header.offset[B+1] = header.offset[B] + (Number_t(1) << ((B+1)/2 - 1));
+  }
+
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  bool ok = file && std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+  // (generated, even if an index is already loaded)
+  std::vector<Number_t> buffer;
+  buffer.reserve(flush_size);
+  Number_t count = 0;
+  for(unsigned B=1; ok && B<=max_bits; ++B) {
+    Number_t k0 = Number_t(1) << ((B-1)/2);
+    for(Number_t k=k0; ok && k < 2*k0; ++k) {
+      buffer.push_back( (k << (B/2)) | reverse_bits(k >> (B%2), B/2) );
+      if(buffer.size() == flush_size) {
+        ok = std::fwrite(buffer.data(), sizeof(Number_t), buffer.size(), file) == buffer.size();
+        count += buffer.size();
+        buffer.clear();
+      }
+    }
+  }
+  ok = ok && std::fwrite(buffer.data(), sizeof(Number_t), buffer.size(), file) == buffer.size();
+  count += buffer.size();
+  if(file && std::fclose(file) != 0) { ok = false; }
+
+  if(!ok) {
+    std::cerr << "failed to write binary palindrome index: " << path << std::endl;
+    exit(1);
+  }
+  std::cout << "wrote " << count << " binary palindromes of up to " << max_bits << " bits to " 
+    << path << std::endl;
+}
+
+Number_t count_binary_palindromes(Number_t lo, Number_t hi)
+{
+  // returns an estimate (to within 1 per bit length) of the number of binary palindromes in [lo,hi]
+  //   the count for each bit length is the difference in the kernels (see BinaryPalindromes)
+  Number_t count = 0;
+  for(unsigned B = bit_length(lo); B <= bit_length(hi); ++B) {
+    Number_t Blo = std::max(lo, Number_t(1) << (B-1));
+    Number_t Bhi = std::min(hi, low_mask(B));
+    count += (Bhi >> (B/2)) - (Blo >> (B/2)) + 1;
+  }
+  return count;
+}
+
+template<class IsBaseNPalindrome_t>
+Number_t search_binary_first(Number_t N, Number_t lo, Number_t hi)
+{
+  // Searches the binary palindromes in [lo,hi] for the smallest base-N palindrome
+  //   (returns 0 if there isn't one)
+  // IsBaseNPalindrome_t may be IsBaseNPalindrome or FastIsBaseNPalindrome
+  IsBaseNPalindrome_t is_base_n_palindrome(N);
+  for(BinaryPalindromes bp(lo); bp.valid(); bp.next()) {
+    Number_t p = bp.value();
+    if(p > hi) { break; }
+    if(is_base_n_palindrome(p)) { return p; }
+  }
+  return 0;
+}
+
+Number_t calc_Pn_binary(Number_t N)
+{
+  // Binary first search: walk the binary palindromes exceeding 2N (in increasing order) 
+  //   until one is also a base-N palindrome.
+  return search_binary_first<IsBaseNPalindrome>(N, 2*N+1, ULLONG_MAX);
+}
+
+Number_t calc_Pn_fastbinary(Number_t N)
+{
+  // Same as calc_Pn_binary, but with the FastIsBaseNPalindrome test
+  return search_binary_first<FastIsBaseNPalindrome>(N, 2*N+1, ULLONG_MAX);
+}
+
+// relative cost of testing a binary palindrome for being a base-N palindrome vs testing
+//   a base-N palindrome for being a binary palindrome (which is still cheaper, even with
+//   the FastIsBaseNPalindrome test, which cut this from 6 to 3)
+const Count_t binary_first_weight = 3;
+
+Number_t calc_Pn_adaptive(Number_t N)
+{
+  // Examines one window of leading digits (a) of one palindrome length (L) at a time, choosing
+  //   whichever search has fewer candidates in the window:
+  //   - base-N first:  there are N^(ceil(L/2)-1) palindromes with leading digit a
+  //   - binary first:  there are roughly sqrt(p) binary palindromes in [p,2p]
+  //   e.g. for L=3, a window of a single leading digit, [a(N^2+1),(a+1)N^2), has N base-N 
+  //   palindromes but only about N/sqrt(a) binary palindromes.
+  //   For odd L, the binary palindromes are the sparser of the two for all but the smallest a,
+  //   for even L, it is the base-N palindromes that are sparser.
+  // Windows span as many leading digits as needed to contain at least min_window base-N
+  //   palindromes (only matters for short palindromes) so that the cost of choosing doesn't
+  //   swamp the cost of the search.
+  const Number_t min_window = 64;
+
+  FastIsBinaryPalindrome is_binary_palindrome;
+
+  Number_t NL = N;  // N^(L-1)
+  for(Count_t L=2; true; ++L) {
+    Number_t w = NL+1;  // 1000...0001 (11 for L=2)
+
+    // number of base-N palindromes with a given leading digit
+    Number_t nbase = 1;
+    for(Count_t i=1; i<(L+1)/2; ++i) { nbase *= N; }
+    Number_t na = (nbase < min_window) ? (min_window + nbase - 1)/nbase : 1;
+
+    Odometer g(N,L);
+    for(Number_t a0 = (L == 2) ? 2 : 1; a0 < N; a0 += na) {  // 22 is the smallest palindrome exceeding 2N
+      // window of numbers with leading digits [a0,a1): [a0 000...000 a0, a1 000...0000)
+      Number_t a1 = std::min(N, a0+na);
+      Number_t lo, hi;
+      if(__builtin_mul_overflow(a0,w,&lo)) {
+        std::cout << "64bit is insufficient" << std::endl;
+        exit(1);
+      }
+      if(__builtin_mul_overflow(a1,NL,&hi)) { hi = 0; }  // (i.e. 2^64)
+      hi -= 1;
+
+      Number_t ncandidates = (a1-a0)*nbase;
+      if(count_binary_palindromes(lo,hi) < ncandidates/binary_first_weight) {
+        Number_t p = search_binary_first<FastIsBaseNPalindrome>(N, lo, hi);
+        if(p) { return p; }
+      } else {
+        // step through all of the base-N palindromes in the window
+        Number_t p;
+        g.seek_outer(a0,p);
+        if(is_binary_palindrome(p)) { return p; }
+        for(Number_t i=1; i<ncandidates; ++i) {
+          g.step(p);
+          if(is_binary_palindrome(p)) { return p; }
+        }
+      }
+    }
+
+    if(__builtin_mul_overflow(NL,N,&NL)) {
+      std::cout << "64bit is insufficient" << std::endl;
+      exit(1);
+    }
+  }
+  return 0;  // we'll never get here, but to keep the compiler happy
+}
+
+class SieveBase
+{
+  // One of the bases (N) being sieved by calc_Pn_sieve_range.
+  // is_palindrome(p) tests p for being a 2, 3, or 4 digit base-N palindrome using the
+  //   precomputed Dividers for N+1, N, N^2, and N^3:
+  //     2 digits:  aa   = a(N+1)                  p % (N+1) == 0
+  //     3 digits:  aba  = aN^2 + (bN+a)           r = p % N^2,  r % N == a
+  //     4 digits:  abba = aN^3 + (bN^2+bN+a)      r = p % N^3,  r % N == a,  r/N = b(N+1)
+  //   where a is the leading digit (p/N^(L-1)) in each case.  Each test exits on the
+  //   first mismatch.
+
+private:
+  Number_t _N;
+  Number_t _N2, _N3, _N4;  // smallest 3, 4, and 5 digit numbers (0 if 2^64 or more)
+  Divider  _divN1, _divN, _divN2, _divN3;
+
+  // the powers of N that overflow 64 bits are replaced by 0 (and their Dividers go unused)
+  static Number_t power(Number_t N, unsigned k)
+  {
+    Number_t r = 1;
+    for(unsigned i=0; i<k; ++i) {
+      if(__builtin_mul_overflow(r,N,&r)) { return 0; }
+    }
+    return r;
+  }
+
+public:
+  SieveBase(Number_t N)
+  : _N(N), _N2(power(N,2)), _N3(power(N,3)), _N4(power(N,4)),
+    _divN1(N+1), _divN(N), _divN2(_N2 ? _N2 : 1), _divN3(_N3 ? _N3 : 1)
+  {}
+
+  Number_t N() const { return _N; }
+
+  // returns false once p exceeds all 4 digit base-N palindromes
+  bool in_range(Number_t p) const { return _N4 == 0 || p < _N4; }
+
+  bool is_palindrome(Number_t p) const
+  {
+    if(_N2 == 0 || p < _N2) {
+      // 2 digits (P(N) must exceed 2N)
+      Number_t r = p;
+      _divN1.divmod(r);
+      return r == 0 && p > 2*_N;
+    }
+    if(_N3 == 0 || p < _N3) {
+      // 3 digits
+      Number_t r = p;
+      Number_t a = _divN2.divmod(r);
+      _divN.divmod(r);
+      return r == a;
+    }
+    // 4 digits
+    Number_t r = p;
+    Number_t a = _divN3.divmod(r);
+    Number_t c = r;
+    Number_t s = _divN.divmod(c);
+    if(c != a) { return false; }
+    _divN1.divmod(s);
+    return s == 0;
+  }
+};
+
+void calc_Pn_sieve_range(Number_t N0, Number_t N1, Number_t *pn)
+{
+  // Inverted sieve: computes P(N) for all N in [N0,N1) in a single pass over the binary
+  //   palindromes rather than separately searching each N.  The binary palindromes (p)
+  //   are walked in increasing order, each is tested against every base that hasn't been 
+  //   resolved yet.  The first p that is a base-N palindrome is P(N), at which point N is
+  //   dropped from the active bases.
+  // Only 2, 3, and 4 digit base-N palindromes are sieved.  Any base still active once p
+  //   exceeds its 4 digit palindromes (never observed in practice) falls back to the
+  //   progression engine.
+  // Note that the cost for each p is proportional to the number of bases still active,
+  //   so the total work is comparable to running the fastbinary engine on each base. What
+  //   is shared is the generation of the binary palindromes. Narrow ranges with similar
+  //   P(N) values fare best.
+  std::vector<SieveBase> active;
+  active.reserve(N1-N0);
+  for(Number_t N=N0; N<N1; ++N) { active.push_back(SieveBase(N)); }
+
+  for(BinaryPalindromes bp(2*N0+1); !active.empty() && bp.valid(); bp.next()) {
+    Number_t p = bp.value();
+    for(size_t i=0; i<active.size(); ) {
+      const SieveBase &base = active[i];
+      if(base.is_palindrome(p) || !base.in_range(p)) {
+        pn[base.N() - N0] = base.in_range(p) ? p : calc_Pn_progression(base.N());
+        // order of the active bases doesn't matter, replace with the last one
+        active[i] = active.back();
+        active.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  // we ran out of 64 bit binary palindromes
+  for(auto base = active.begin(); base!=active.end(); ++base) {
+    pn[base->N() - N0] = calc_Pn_progression(base->N());
+  }
+}
+
+Number_t calc_Pn_sieve(Number_t N)
+{
+  // The sieve engine on its own for a single base (see calc_Pn_sieve_range)
+  Number_t pn;
+  calc_Pn_sieve_range(N,N+1,&pn);
+  return pn;
+}
+
+class LaneSearch
+{
+  // Searches the 2 and 3 digit palindromes of several bases at once, one base per lane of
+  //   BatchIsBinaryPalindrome::match_mask (see calc_Pn_lanes_range).
+  // Above N~40, P(N) is almost always a 3 digit palindrome, (a)(b)(a) = a(N^2+1) + bN.  The
+  //   search of every base is then the same pair of loops, only with different weights.
+  //   Each lane walks one row of its base at a time, stepping p by the weight of the inner
+  //   digit (w) until the row runs out:
+  //     2 digits:  p = a(N+1),           a = 2..N-1     (one row, w = N+1)
+  //     3 digits:  p = a(N^2+1) + bN,    b = 0..N-1     (one row for each a, w = N)
+  //   All of the lanes are stepped and tested together.  Only the lanes that found P(N) or
+  //   reached the end of their row drop out of the vector loop, to move on to the next row
+  //   of their base or to be refilled with the next base.  So no lane sits idle until the
+  //   bases run out.
+  // Only the odd candidates are stepped through (see start_row), for an even N that is every
+  //   other row, for an odd N every other candidate of each row.
+  // A base without a 2 or 3 digit P(N) (or whose 3 digit palindromes don't fit in 64 bits)
+  //   is left to the progression engine.
+
+public:
+  static const Count_t lanes = BatchIsBinaryPalindrome::lanes;
+
+private:
+  // the state that is stepped, one entry per lane
+  alignas(64) Number_t _p[lanes];     // current candidate
+  alignas(64) Number_t _w[lanes];     // weight of the inner digit
+  alignas(64) Number_t _left[lanes];  // number of candidates left in the row (including p)
+
+  Number_t _N[lanes];  // base of each lane (0 if the lane is idle)
+  Number_t _a[lanes];  // outer digit of the current row (0 for the 2 digit row)
+
+  Number_t  _N0, _N1;  // range of bases
+  Number_t  _next;     // next base to be handed to a lane
+  Number_t *_pn;       // P(N) of each base in the range
+  Count_t   _active;   // number of lanes with a base
+
+  BatchIsBinaryPalindrome _is_binary_palindrome;
+
+public:
+  LaneSearch(Number_t N0, Number_t N1, Number_t *pn)
+  : _N0(N0), _N1(N1), _next(N0), _pn(pn), _active(0)
+  {
+    for(Count_t i=0; i<lanes; ++i) { 
+      _N[i] = 0;
+      fill(i);
+      _p[i] += _w[i];
+    }
+  }
+
+  void run()
+  {
+    while(_active) {
+      // step all of the lanes until at least one finds P(N) or runs out of its row
+      unsigned found, done;
+      while(true) {
+        found = _is_binary_palindrome.match_mask(_p);
+        done  = 0;
+        for(Count_t i=0; i<lanes; ++i) {
+          _left[i] -= 1;
+          done |= unsigned(_left[i] == 0) << i;
+        }
+        if(found | done) { break; }
+        for(Count_t i=0; i<lanes; ++i) { _p[i] += _w[i]; }
+      }
+
+      for(unsigned m = found|done; m; m &= m-1) {
+        Count_t i = __builtin_ctz(m);
+        if(found & (1u << i)) {
+          _pn[_N[i] - _N0] = _p[i];
+          fill(i);
+        } else {
+          next_row(i);
+        }
+      }
+      for(Count_t i=0; i<lanes; ++i) { _p[i] += _w[i]; }
+    }
+  }
+
+private:
+  // Positions lane i on the odd candidates of the row p0, p0+w, ... p0+(n-1)w
+  //   (one step short of the first, the next step of the lanes lands on it)
+  //   returns false if none of them are odd
+  //   (all binary palindromes are odd: for an even w, either all or none of the row is odd,
+  //    for an odd w, every other candidate is)
+  bool start_row(Count_t i, Number_t p0, Number_t w, Number_t n)
+  {
+    if(w%2 == 0) {
+      if(p0%2 == 0) { return false; }
+    } else {
+      if(p0%2 == 0) { p0 += w; n -= 1; }
+      n  = (n+1)/2;
+      w *= 2;
+    }
+    if(n == 0) { return false; }
+    _p[i]    = p0 - w;
+    _w[i]    = w;
+    _left[i] = n;
+    return true;
+  }
+
+  // Hands the next base to lane i (or leaves it idle once the bases run out)
+  void fill(Count_t i)
+  {
+    if(_N[i]) { --_active; }
+    _N[i] = 0;
+    while(_N[i] == 0 && _next < _N1) {
+      Number_t N = _next++;
+      Number_t N2, N3;
+      if(__builtin_mul_overflow(N,N,&N2) || __builtin_mul_overflow(N2,N,&N3)) {
+        _pn[N - _N0] = calc_Pn_progression(N);
+      } else {
+        _N[i] = N;
+      }
+    }
+
+    if(_N[i] == 0) {
+      // idle: an even p is never a binary palindrome, and the row never runs out
+      _p[i]    = 2;
+      _w[i]    = 0;
+      _left[i] = ~Number_t(0);
+      return;
+    }
+    ++_active;
+    Number_t N = _N[i];
+    _a[i] = 0;
+    // (22 is the smallest palindrome exceeding 2N)
+    if(!start_row(i, 2*(N+1), N+1, N-2)) { next_row(i); }
+  }
+
+  // Moves lane i on to the next row (with odd candidates) of its base
+  void next_row(Count_t i)
+  {
+    Number_t N = _N[i];
+    for(Number_t a = _a[i]+1; a < N; ++a) {
+      if(start_row(i, a*(N*N+1), N, N)) { 
+        _a[i] = a;
+        return; 
+      }
+    }
+    // P(N) has more than 3 digits
+    _pn[N - _N0] = calc_Pn_progression(N);
+    fill(i);
+  }
+};
+
+void calc_Pn_lanes_range(Number_t N0, Number_t N1, Number_t *pn)
+{
+  // Computes P(N) for all N in [N0,N1), BatchIsBinaryPalindrome::lanes bases at a time
+  //   (see LaneSearch)
+  LaneSearch(N0,N1,pn).run();
+}
+
+Number_t calc_Pn_lanes(Number_t N)
+{
+  // The lanes engine on its own for a single base (see calc_Pn_lanes_range)
+  Number_t pn;
+  calc_Pn_lanes_range(N,N+1,&pn);
+  return pn;
+}
+
+class BoundedSearch
+{
+  // Threshold bounded search for a double palindrome (used by --bounded)
+  //   A base (N) can only extend the solution sequence if P(N) exceeds the largest P(N) found
+  //   so far (max_pn).  Finding ANY number in (2N,max_pn] that is both a base-N and a binary
+  //   palindrome rules N out, so that search doesn't need to proceed in increasing order.
+  //   The exact P(N) only needs to be found for the bases that survive.
+  //
+  // The base-N palindromes below the cutoff are split into work items (a range of leading
+  //   digits for a given length) shared by the calling thread and a pool of worker threads:
+  //   - 2 digits: a single item
+  //   - 3 and 4 digits: each leading digit is a search_progression, clipped at the cutoff
+  //   - 5+ digits: stepped with an Odometer
+  //   Items are listed in increasing order of palindrome.  For an existence search, all threads
+  //   stop as soon as any item finds a double palindrome.  For an exact search, they only stop
+  //   claiming items once they are past the first item with a hit (which holds the smallest).
+  // Most bases are ruled out by one of the first few items, so the calling thread works through
+  //   the first serial_items on its own before waking the workers.
+
+private:
+  struct Item
+  {
+    Count_t  L;       // palindrome length
+    Number_t a0, a1;  // range of leading digits [a0,a1)
+    Number_t hit;     // smallest double palindrome found in the item (0 if none)
+  };
+
+  static const size_t   serial_items = 4;
+  static const Number_t min_item     = 1024; // minimum number of base-N palindromes per item
+  static const size_t   no_item      = ~size_t(0);
+
+  std::vector<std::thread> _workers;
+  std::mutex               _mutex;
+  std::condition_variable  _start_cv;  // signals the workers to start on the current search
+  std::condition_variable  _done_cv;   // signals the caller that the workers are all done
+  unsigned                 _search;    // incremented each time the workers are started
+  unsigned                 _nbusy;     // number of workers still working on the current search
+  bool                     _quit;
+
+  // current search
+  Number_t            _N;
+  Number_t            _cutoff;
+  bool                _exact;
+  std::vector<Item>   _items;
+  std::atomic<size_t> _next_item;
+  std::atomic<size_t> _hit_item;  // first item with a hit (no_item if none)
+
+public:
+  // nthreads includes the calling thread
+  BoundedSearch(unsigned nthreads)
+  : _search(0), _nbusy(0), _quit(false), _N(0), _cutoff(0), _exact(false), _next_item(0), _hit_item(no_item)
+  {
+    for(unsigned i=1; i<nthreads; ++i) {
+      _workers.push_back( std::thread(&BoundedSearch::worker, this) );
+    }
+  }
+
+  ~BoundedSearch()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _quit = true;
+    }
+    _start_cv.notify_all();
+    for(auto w = _workers.begin(); w!=_workers.end(); ++w) { w->join(); }
+  }
+
+  // returns a number in (2N,cutoff] that is both a base-N and binary palindrome (0 if none)
+  //   if exact is set, this is the smallest such number
+  Number_t search(Number_t N, Number_t cutoff, bool exact)
+  {
+    _N      = N;
+    _cutoff = cutoff;
+    _exact  = exact;
+    build_items();
+    _hit_item = no_item;
+
+    size_t nserial = _workers.empty() ? _items.size() : std::min(serial_items, _items.size());
+    for(size_t i=0; i<nserial && !stop(i); ++i) { run_item(i); }
+
+    if(nserial < _items.size() && !stop(nserial)) {
+      _next_item = nserial;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _nbusy = _workers.size();
+        ++_search;
+      }
+      _start_cv.notify_all();
+      run_items();
+
+      std::unique_lock<std::mutex> lock(_mutex);
+      _done_cv.wait(lock, [this]{ return _nbusy == 0; });
+    }
+
+    size_t i = _hit_item;
+    return (i == no_item) ? 0 : _items[i].hit;
+  }
+
+private:
+  void worker()
+  {
+    unsigned search = 0;
+    while(true) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _start_cv.wait(lock, [&]{ return _quit || _search != search; });
+        if(_quit) { return; }
+        search = _search;
+      }
+      run_items();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_nbusy;
+      }
+      _done_cv.notify_one();
+    }
+  }
+
+  // true if item i no longer needs to be searched
+  bool stop(size_t i) const
+  {
+    size_t hit = _hit_item;
+    return _exact ? i > hit : hit != no_item;
+  }
+
+  void run_items()
+  {
+    for(size_t i = _next_item++; i < _items.size() && !stop(i); i = _next_item++) { run_item(i); }
+  }
+
+  void build_items()
+  {
+    _items.clear();
+    Number_t NL = _N;  // N^(L-1), the smallest length L palindrome is NL+1
+    for(Count_t L=2; NL < _cutoff; ++L) {
+      // number of base-N palindromes with a given leading digit
+      Number_t nbase = 1;
+      for(Count_t i=1; i<(L+1)/2; ++i) { nbase *= _N; }
+      Number_t na = (nbase < min_item) ? (min_item + nbase - 1)/nbase : 1;
+
+      // leading digits of the length L palindromes that don't exceed the cutoff
+      //   (or 64 bits, an exact search returns 0 if it runs out of 64 bit palindromes)
+      Number_t a1 = std::min(_N, (_cutoff-1)/NL + 1);
+      a1 = std::min(a1, Number_t(ULLONG_MAX/NL));
+      if(L == 2) { 
+        _items.push_back( Item{L, 2, a1, 0} );  // 22 is the smallest palindrome exceeding 2N
+      } else {
+        for(Number_t a = 1; a < a1; a += na) { _items.push_back( Item{L, a, std::min(a1, a+na), 0} ); }
+      }
+
+      if(__builtin_mul_overflow(NL,_N,&NL)) { break; }
+    }
+  }
+
+  void run_item(size_t i)
+  {
+    Item &item = _items[i];
+    FastIsBinaryPalindrome is_binary_palindrome;
+
+    Number_t NL = 1;  // N^(L-1)
+    for(Count_t j=1; j<item.L; ++j) { NL *= _N; }
+
+    Number_t hit = 0;
+    if(item.L == 2) {
+      for(Number_t a = item.a0; a < item.a1 && !hit; ++a) {
+        Number_t p = a*(_N+1);
+        if(p > _cutoff) { break; }
+        if(is_binary_palindrome(p)) { hit = p; }
+      }
+    } else if(item.L <= 4) {
+      Number_t w = (item.L == 3) ? _N : NL/_N + _N;  // weight of the middle digit(s)
+      for(Number_t a = item.a0; a < item.a1 && !hit && !stop(i); ++a) {
+        Number_t c = a*(NL+1);
+        if(c > _cutoff) { break; }
+        Number_t bmax = std::min(_N-1, (_cutoff - c)/w);
+        hit = search_progression(c, w, bmax, is_binary_palindrome);
+      }
+    } else {
+      Number_t nbase = 1;
+      for(Count_t j=1; j<(item.L+1)/2; ++j) { nbase *= _N; }
+
+      Odometer g(_N,item.L);
+      Number_t p;
+      g.seek_outer(item.a0,p);
+      Number_t n = (item.a1 - item.a0)*nbase;
+      //   (no step past the last palindrome of the item, which might not fit in 64 bits)
+      for(Number_t k=1; p <= _cutoff; ++k) {
+        if(is_binary_palindrome(p)) { hit = p; break; }
+        if(k == n) { break; }
+        if((k & 0xfff) == 0 && stop(i)) { break; }
+        g.step(p);
+      }
+    }
+
+    if(hit) {
+      item.hit = hit;
+      // record i as the first item with a hit (unless there is an earlier one)
+      size_t cur = _hit_item;
+      while(i < cur && !_hit_item.compare_exchange_weak(cur,i)) {}
+    }
+  }
+};
+
+Number_t calc_Pn_bounded(Number_t N)
+{
+  // The exact search of BoundedSearch with a single thread (allows --verify to cover it)
+  BoundedSearch bounded_search(1);
+  return bounded_search.search(N, ULLONG_MAX, true);
+}
+
+template<class Value_t>
+Count_t count_candidates(Number_t N, Value_t pn, Count_t &L)
+{
+  // see generator_candidates
+  Count_t count = 0;
+  Value_t NL    = N;  // N^(L-1)
+  Count_t Nh    = 1;  // N^(ceil(L/2)-1)
+  for(L=2; NL <= pn/N; ++L) {
+    // all (N-1)*N^(ceil(L/2)-1) palindromes of length L are below pn
+    count += (N-1)*Nh;
+    NL *= N;
+    if(L%2 == 0) { Nh *= N; }
+  }
+  Value_t k = 0;
+  palindrome_index(N, L, pn, k);
+  return count + Count_t(k) + 1 - 1;  // (+1 for pn itself, -1 for 11, which isn't a candidate)
+}
+
+Count_t generator_candidates(Number_t N, Wide_t pn, Count_t &L)
+{
+  // returns the number of base-N palindromes in [22,pn], i.e. the number of candidates the
+  //   Generator steps through to find P(N)=pn, and the number of digits in pn (L)
+  //   (in 64 bits whenever pn fits)
+  if(pn <= ULLONG_MAX) { return count_candidates(N, Number_t(pn), L); }
+  return count_candidates(N, pn, L);
+}
+
+struct alignas(64) ProgressSlot
+{
+  // Progress of one thread through the sweep, updated once per base (or block of bases for
+  //   range mode engines) by the thread that owns it: running totals of the bases and their
+  //   candidates, and the longest P(N) so far.  The slot is only ever written by that
+  //   thread, so the updates are plain (relaxed) loads and stores, i.e. no locked
+  //   instructions.  seq is odd while an update is under way, which lets the monitor spot
+  //   (and retry) a torn read.
+  //   Each slot has a cache line to itself so the threads don't share one.
+  std::atomic<Count_t>  seq;         // two per update
+  std::atomic<Number_t> N;           // last base completed
+  std::atomic<Count_t>  bases;       // bases completed
+  std::atomic<Count_t>  candidates;  // base-N palindromes up to P(N) (see generator_candidates)
+  std::atomic<Count_t>  max_L;       // longest palindrome length (base-N digits) visited so far
+
+  struct Sample
+  {
+    Number_t N;
+    Count_t  bases;
+    Count_t  candidates;
+    Count_t  max_L;
+  };
+
+  ProgressSlot() : seq(0), N(0), bases(0), candidates(0), max_L(0) {}
+
+  void update(Number_t N0, Number_t N1, const Wide_t *pn)
+  {
+    // P(N)=pn[N-N0] for N in [N0,N1) has been completed
+    Count_t ncandidates = 0;
+    Count_t L1 = max_L.load(std::memory_order_relaxed);
+    for(Number_t N=N0; N<N1; ++N) {
+      Count_t L;
+      ncandidates += generator_candidates(N, pn[N-N0], L);
+      L1 = std::max(L1, L);
+    }
+
+    Count_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s+1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    N.store(N1-1, std::memory_order_relaxed);
+    bases.store(bases.load(std::memory_order_relaxed) + (N1-N0), std::memory_order_relaxed);
+    candidates.store(candidates.load(std::memory_order_relaxed) + ncandidates, std::memory_order_relaxed);
+    max_L.store(L1, std::memory_order_relaxed);
+    seq.store(s+2, std::memory_order_release);
+  }
+
+  // (called by the monitor)
+  Sample sample() const
+  {
+    while(true) {
+      Count_t s = seq.load(std::memory_order_acquire);
+      Sample rval = { N.load(std::memory_order_relaxed), bases.load(std::memory_order_relaxed),
+                      candidates.load(std::memory_order_relaxed), max_L.load(std::memory_order_relaxed) };
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if(s%2 == 0 && seq.load(std::memory_order_relaxed) == s) { return rval; }
+    }
+  }
+};
+
+class Progress
+{
+  // Live progress of the sweep (see ProgressSlot), reported to stderr (or a status file)
+  //   whenever the process receives SIGUSR1 (kill -USR1 <pid>) and, optionally, every few
+  //   seconds (--progress).  The reports come from a monitor thread that samples the slots
+  //   of all of the threads, so the sweep itself never stops, locks or does any I/O.
+  //   Nothing is started (and the threads don't touch their slots) unless progress
+  //   reporting was asked for (--progress or --status).
+  //   - N:             last base completed
+  //   - bases/s, candidates/s:  since the previous report
+  //   - L:             longest palindrome length visited so far
+private:
+  typedef std::chrono::steady_clock Clock_t;
+
+  typedef ProgressSlot::Sample Sample;
+
+  std::mutex       _mutex;
+  std::vector< std::unique_ptr<ProgressSlot> > _slots;  // (one per thread, in order of first use)
+
+  // monitor thread
+  std::thread             _monitor;
+  std::condition_variable _wakeup;
+  bool                    _stop;
+  time_t                  _interval;     // seconds between reports (0 for SIGUSR1 only)
+  std::string             _path;         // status file (stderr if empty)
+  Clock_t::time_point     _start;
+  Clock_t::time_point     _last_report;
+  std::vector<Sample>     _last_samples;
+
+  static volatile sig_atomic_t _requested;  // set by SIGUSR1
+  static bool _enabled;                     // (see start)
+
+public:
+  static Progress &instance()
+  {
+    static Progress progress;
+    return progress;
+  }
+
+  // true once start has been called (before any of the worker threads exist)
+  static bool enabled() { return _enabled; }
+
+  ProgressSlot *slot()
+  {
+    // new slot for the calling thread (see progress_slot)
+    std::lock_guard<std::mutex> lock(_mutex);
+    _slots.push_back( std::unique_ptr<ProgressSlot>(new ProgressSlot) );
+    return _slots.back().get();
+  }
+
+  void start(time_t interval, const std::string &path)
+  {
+    _interval = interval;
+    _path     = path;
+    _start    = _last_report = Clock_t::now();
+    _enabled  = true;
+    std::signal(SIGUSR1, on_signal);
+    _monitor = std::thread(&Progress::monitor, this);
+  }
+
+  void stop()
+  {
+    if(!_monitor.joinable()) { return; }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _wakeup.notify_all();
+    _monitor.join();
+  }
+
+private:
+  Progress() : _stop(false), _interval(0) {}
+  ~Progress() { stop(); }
+
+  static void on_signal(int) { _requested = 1; }
+
+  void monitor()
+  {
+    // (signal handlers can't do much beyond setting a flag, so the flag is polled here)
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(!_stop) {
+      _wakeup.wait_for(lock, std::chrono::milliseconds(100));
+      time_t since_report = std::chrono::duration_cast<std::chrono::seconds>(Clock_t::now() - _last_report).count();
+      if(_requested || (_interval > 0 && since_report >= _interval)) {
+        _requested = 0;
+        report();
+      }
+    }
+  }
+
+  void report()
+  {
+    // (called with _mutex locked)
+    Clock_t::time_point now = Clock_t::now();
+    double seconds = std::chrono::duration<double>(now - _last_report).count();
+    _last_report = now;
+    _last_samples.resize(_slots.size(), Sample{0,0,0,0});
+
+    std::stringstream out;
+    out << "progress " << hh_mm_ss(std::chrono::duration_cast<std::chrono::seconds>(now - _start).count()) << std::endl;
+    Sample all = {0,0,0,0};  // (bases and candidates since the previous report)
+    for(size_t i=0; i<_slots.size(); ++i) {
+      Sample sample = _slots[i]->sample();
+      if(sample.bases == 0) { continue; }  // (threads that never examined a base)
+      out << "  thread " << std::setw(3) << i+1 << ":  ";
+      print(out, sample, _last_samples[i], seconds);
+      all.N           = std::max(all.N, sample.N);
+      all.bases      += sample.bases      - _last_samples[i].bases;
+      all.candidates += sample.candidates - _last_samples[i].candidates;
+      all.max_L       = std::max(all.max_L, sample.max_L);
+      _last_samples[i] = sample;
+    }
+    out << "  all threads:  ";
+    print(out, all, Sample{0,0,0,0}, seconds);
+
+    if(_path.empty()) { 
+      std::cerr << out.str(); 
+    } else {
+      // (replaced in one go, so readers never see a partial report)
+      std::string tmp_path = _path + ".tmp";
+      {
+        std::ofstream file(tmp_path.c_str());
+        file << out.str();
+      }
+      std::rename(tmp_path.c_str(), _path.c_str());
+    }
+  }
+
+  static void print(std::ostream &out, const Sample &sample, const Sample &last, double seconds)
+  {
+    out << "N=" << sample.N
+      << "  bases/s=" << std::fixed << std::setprecision(1) << (sample.bases - last.bases)/seconds
+      << "  candidates/s=" << std::setprecision(0) << (sample.candidates - last.candidates)/seconds
+      << "  L=" << sample.max_L << std::endl;
+  }
+};
+
+volatile sig_atomic_t Progress::_requested = 0;
+bool Progress::_enabled = false;
+
+// (constant initialized, so the hot path reads it without a call to a thread_local wrapper)
+thread_local ProgressSlot *progress_slot = NULL;
+
+inline void record_progress(Number_t N0, Number_t N1, const Wide_t *pn)
+{
+  // P(N)=pn[N-N0] for N in [N0,N1) has been completed by the calling thread
+  if(!Progress::enabled() || N1 == N0) { return; }
+  if(progress_slot == NULL) { progress_slot = Progress::instance().slot(); }
+  progress_slot->update(N0,N1,pn);
+}
+
+class StatsSink
+{
+  // Per-base statistics (--stats), written as CSV with one row per base (or one per block of
+  //   bases for range mode engines):
+  //     N,bases,pn,L,candidates,tested,early_rejects,passed,ns
+  //   - bases:      number of bases covered by the row (N through N+bases-1)
+  //   - pn:         P(N) (the largest P(N) in the block)
+  //   - L:          number of base-N digits in P(N), i.e. the longest palindrome length visited
+  //   - candidates: number of base-N palindromes the Generator steps through to reach P(N)
+  //                 (i.e. without any pruning), computed from P(N) rather than counted
+  //   - tested, early_rejects, passed:  see SearchCounters, these columns are left out
+  //                 altogether unless compiled with -DPALINDROME_STATS (rather than all 0)
+  //   - ns:         time spent computing P(N)
+  // Rows are formatted into a buffer that is only written to the file once it is large (or
+  //   the sink is destroyed).  Rows from the worker threads are written in the order they
+  //   complete.  When --stats isn't used, none of this code is ever reached.
+
+public:
+  typedef std::chrono::steady_clock Clock_t;
+
+private:
+  static const size_t flush_size = 1<<16;
+
+  std::ofstream _out;
+  std::string   _buffer;
+  std::mutex    _mutex;
+
+public:
+  StatsSink(const std::string &path) : _out(path.c_str())
+  {
+    _out << "N,bases,pn,L,candidates," << (search_counts ? "tested,early_rejects,passed," : "") << "ns" << std::endl;
+  }
+
+  ~StatsSink() { _out << _buffer; }
+
+  bool ok() const { return bool(_out); }
+
+  // starts the measurement of the next row (for the calling thread)
+  Clock_t::time_point start()
+  {
+    search_counters = SearchCounters{0,0,0};
+    return Clock_t::now();
+  }
+
+  // completes the measurement of the row for the bases [N0,N1) started at t0
+  void record(Number_t N0, Number_t N1, const Wide_t *pn, Clock_t::time_point t0)
+  {
+    Count_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock_t::now() - t0).count();
+
+    Wide_t   max_pn = 0;
+    Count_t  max_L  = 0;
+    Count_t  candidates = 0;
+    for(Number_t N=N0; N<N1; ++N) {
+      Count_t L = 0;
+      candidates += generator_candidates(N, pn[N-N0], L);
+      max_pn = std::max(max_pn, pn[N-N0]);
+      max_L  = std::max(max_L, L);
+    }
+
+    std::stringstream row;
+    row << N0 << "," << (N1-N0) << "," << wide_str(max_pn) << "," << max_L << "," << candidates << ",";
+    if(search_counts) {
+      row << search_counters.tested << "," << search_counters.early_rejects << "," 
+        << search_counters.passed << ",";
+    }
+    row << ns << "\n";
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _buffer += row.str();
+    if(_buffer.size() >= flush_size) {
+      _out << _buffer;
+      _buffer.clear();
+    }
+  }
+
+};
+
+struct PnTableHeader
+{
+  // start of a P(N) table file (see PnTableWriter)
+  char     magic[8];    // "PNTABLE1"
+  uint64_t entry_size;  // sizeof(PnTableEntry)
+  uint64_t first_N;     // base of the first entry
+};
+
+struct PnTableEntry
+{
+  // P(N) of one base in a P(N) table file, the base is implied by the entry's position
+  uint64_t pn_lo;  // P(N), low and high 64 bits
+  uint64_t pn_hi;
+  uint64_t L;      // number of base-N digits in P(N)
+};
+
+static const char pn_table_magic[8] = {'P','N','T','A','B','L','E','1'};
+
+Count_t base_n_length(Wide_t pn, Number_t N)
+{
+  // number of base-N digits in pn (pn > 0)
+  Count_t L  = 1;
+  Wide_t  NL = N;  // N^L
+  for( ; NL <= pn; ++L) {
+    if(NL > ~Wide_t(0) / N) { return L+1; }
+    NL *= N;
+  }
+  return L;
+}
+
+class PnTableWriter
+{
+  // P(N) of every base examined by the sweep (--table), not just the ones that make it into
+  //   the solution sequence, so the full P(N) curve can be analyzed (or the solution sequence
+  //   rebuilt) later without computing any of it again (see PnTable and --query).
+  // The file is a PnTableHeader followed by a fixed width PnTableEntry for every base from
+  //   first_N on, in increasing N, so the entry of base N is at a fixed offset:
+  //     sizeof(PnTableHeader) + (N - first_N) * sizeof(PnTableEntry)
+  //   (in the native byte order, the file is meant to be read back on the same machine)
+  // The Sweep feeds the entries in order of N (also for the parallel sweep), which are
+  //   buffered and only written once there are flush_size of them.  The Sweep flushes the
+  //   table before each checkpoint, so a resumed sweep (--resume) continues the table from
+  //   the checkpoint's next_N (anything written beyond it is dropped).
+
+private:
+  static const size_t flush_size = 1<<16;  // (1.5MB of entries)
+
+  std::FILE *_file;
+  std::vector<PnTableEntry> _buffer;
+
+public:
+  PnTableWriter(const std::string &path, Number_t first_N, Number_t next_N) : _file(NULL)
+  {
+    off_t offset = sizeof(PnTableHeader) + (next_N - first_N) * sizeof(PnTableEntry);
+    if(next_N == first_N) {
+      _file = std::fopen(path.c_str(), "wb");
+      PnTableHeader header = { {}, sizeof(PnTableEntry), first_N };
+      std::memcpy(header.magic, pn_table_magic, sizeof(header.magic));
+      if(_file && std::fwrite(&header, sizeof(header), 1, _file) != 1) { close(); }
+    } else {
+      // the table must be from the same sweep, and must cover all of the bases before next_N
+      _file = std::fopen(path.c_str(), "r+b");
+      PnTableHeader header;
+      struct stat st;
+      if( _file && ( std::fread(&header, sizeof(header), 1, _file) != 1 
+                     || std::memcmp(header.magic, pn_table_magic, sizeof(header.magic)) != 0
+                     || header.entry_size != sizeof(PnTableEntry) || header.first_N != first_N
+                     || fstat(fileno(_file), &st) != 0 || st.st_size < offset
+                     || ftruncate(fileno(_file), offset) != 0 
+                     || fseeko(_file, offset, SEEK_SET) != 0 ) ) { 
+        close(); 
+      }
+    }
+    _buffer.reserve(flush_size);
+  }
+
+  ~PnTableWriter() { flush(); close(); }
+
+  bool ok() const { return _file != NULL; }
+
+  // appends P(N) for the next base
+  void append(Number_t N, Wide_t pn)
+  {
+    PnTableEntry entry = { uint64_t(pn), uint64_t(pn >> 64), base_n_length(pn,N) };
+    _buffer.push_back(entry);
+    if(_buffer.size() >= flush_size) { flush(); }
+  }
+
+  // writes all of the buffered entries to the file
+  void flush()
+  {
+    if(_file && !_buffer.empty()) {
+      if(std::fwrite(_buffer.data(), sizeof(PnTableEntry), _buffer.size(), _file) != _buffer.size()) {
+        std::cerr << "failed to write P(N) table" << std::endl;
+      }
+      std::fflush(_file);
+    }
+    _buffer.clear();
+  }
+
+private:
+  void close()
+  {
+    if(_file) { std::fclose(_file); }
+    _file = NULL;
+  }
+};
+
+// Each engine provides a different means of computing P(N).  They must all produce the same
+//   results (see --verify).  The first engine listed is the reference implementation.
+// Engines that can compute P(N) more efficiently for a whole range of N at once (range mode)
+//   also provide calc_Pn_range, which fills in pn[N-N0] for N in [N0,N1).
+// Engines whose P(N) may outgrow 64 bits also provide calc_Pn_wide, which the sweep uses in
+//   place of calc_Pn.  (calc_Pn then exits if P(N) doesn't fit.)
+typedef Number_t (*CalcPn_t)(Number_t N);
+typedef void     (*CalcPnRange_t)(Number_t N0, Number_t N1, Number_t *pn);
+typedef Wide_t   (*CalcPnWide_t)(Number_t N);
+
+struct Engine
+{
+  const char   *name;
+  CalcPn_t      calc_Pn;
+  const char   *description;
+  CalcPnRange_t calc_Pn_range;  // NULL if the engine has no range mode
+  CalcPnWide_t  calc_Pn_wide;   // NULL if the engine is limited to 64 bits
+
+  // P(N) for N in [N0,N1) as used by the sweep (see above)
+  void calc_range(Number_t N0, Number_t N1, Wide_t *pn) const
+  {
+    if(calc_Pn_range) { 
+      PERF_SCOPE(calc_Pn_range);
+      calc_range_64(N0,N1,pn); 
+      record_progress(N0,N1,pn);
+      return; 
+    }
+    for(Number_t N=N0; N<N1; ++N) { 
+      PERF_SCOPE(calc_Pn);
+      pn[N-N0] = calc_wide(N); 
+      record_progress(N,N+1,pn+(N-N0));
+    }
+  }
+
+  // same as above, with a row of statistics for each base (or block for range mode)
+  void calc_range(Number_t N0, Number_t N1, Wide_t *pn, StatsSink *stats) const
+  {
+    if(stats == NULL) { 
+      calc_range(N0,N1,pn); 
+    } else if(calc_Pn_range) {
+      StatsSink::Clock_t::time_point t0 = stats->start();
+      PERF_SCOPE(calc_Pn_range);
+      calc_range_64(N0,N1,pn);
+      stats->record(N0,N1,pn,t0);
+      record_progress(N0,N1,pn);
+    } else {
+      for(Number_t N=N0; N<N1; ++N) {
+        StatsSink::Clock_t::time_point t0 = stats->start();
+        PERF_SCOPE(calc_Pn);
+        pn[N-N0] = calc_wide(N);
+        stats->record(N,N+1,pn+(N-N0),t0);
+        record_progress(N,N+1,pn+(N-N0));
+      }
+    }
+  }
+
+private:
+  Wide_t calc_wide(Number_t N) const { return calc_Pn_wide ? calc_Pn_wide(N) : calc_Pn(N); }
+
+  void calc_range_64(Number_t N0, Number_t N1, Wide_t *pn) const
+  {
+    std::vector<Number_t> pn_64(N1-N0);
+    calc_Pn_range(N0,N1,pn_64.data());
+    std::copy(pn_64.begin(), pn_64.end(), pn);
+  }
+};
+
+Number_t calc_Pn_wide_64(Number_t N)
+{
+  // calc_Pn_wide where only 64 bits will do (e.g. the benchmark)
+  Wide_t pn = calc_Pn_wide(N);
+  if(pn > ULLONG_MAX) { insufficient_bits<Number_t>(); }
+  return Number_t(pn);
+}
+
+const Engine engines[] = {
+  { "tree",     calc_Pn<Generator>, "tree of palindrome generating operations (reference)", NULL, NULL },
+  { "masked",   calc_Pn<MaskedGenerator>, "tree that skips the outer digits ruled out mod 2^s (even N)", NULL, NULL },
+  { "odometer", calc_Pn<Odometer>,  "kernel digit counter with a table of deltas", NULL, NULL },
+  { "pruning",  calc_Pn<PruningOdometer>, "odometer that skips blocks whose bits cannot be mirrored", NULL, NULL },
+  { "fastcheck", calc_Pn<Odometer,FastIsBinaryPalindrome>, "odometer with the table driven binary palindrome check", NULL, NULL },
+  { "batch",    calc_Pn_batch,      "odometer filling batches of candidates checked with SIMD", NULL, NULL },
+  { "binary",   calc_Pn_binary,     "binary palindromes tested for being base-N palindromes", NULL, NULL },
+  { "fastbinary", calc_Pn_fastbinary, "binary first, with precomputed reciprocals of the powers of N", NULL, NULL },
+  { "adaptive", calc_Pn_adaptive,   "base-N first or binary first (per leading digit), whichever is cheaper", NULL, NULL },
+  { "seek",     calc_Pn_seek,       "tree generator split into chunks, each started with seek", NULL, NULL },
+  { "fixed",    calc_Pn_fixed,      "compile time nested loops for short palindromes", NULL, NULL },
+  { "progression", calc_Pn_progression, "fixed, with 3/4 digit middle digits solved mod 2^t", NULL, NULL },
+  { "bounded",  calc_Pn_bounded,    "leading digit work items, as used by --bounded (1 thread)", NULL, NULL },
+  { "sieve",    calc_Pn_sieve,      "one pass over the binary palindromes for a range of bases", calc_Pn_sieve_range, NULL },
+  { "lanes",    calc_Pn_lanes,      "2/3 digit search of several bases at once, one per SIMD lane", calc_Pn_lanes_range, NULL },
+  { "wide",     calc_Pn_wide_64,    "progression, continued in 128 bits by the bases whose P(N) needs it", NULL, calc_Pn_wide },
+};
+const Engine *engines_end = engines + sizeof(engines)/sizeof(Engine);
+
+const Engine *find_engine(const std::string &name)
+{
+  for(const Engine *e = engines; e!=engines_end; ++e) {
+    if(name == e->name) { return e; }
+  }
+  return NULL;
+}
+
+bool verify_engines(Number_t N0, Number_t N1)
+{
+  // Compares P(N) from each of the engines against the reference engine for N in [N0,N1)
+  //   mismatches are reported to stdout
+  //   returns true if all engines agree for every N
+  //   range mode engines are run over the entire range at once
+  Count_t nbad = 0;
+  std::vector<Wide_t> pn(N1-N0), epn(N1-N0);
+  engines->calc_range(N0,N1,pn.data());
+  for(const Engine *e = engines+1; e!=engines_end; ++e) {
+    e->calc_range(N0,N1,epn.data());
+    for(Number_t N=N0; N<N1; ++N) {
+      if(epn[N-N0] != pn[N-N0]) {
+        std::cout << "MISMATCH N=" << N << ": " << engines->name << "=" << wide_str(pn[N-N0]) 
+          << " " << e->name << "=" << wide_str(epn[N-N0]) << std::endl;
+        ++nbad;
+      }
+    }
+  }
+  std::cout << "verified " << (N1-N0) << " bases [" << N0 << "," << N1 << "): " 
+    << nbad << " mismatches" << std::endl;
+  return nbad == 0;
+}
+
+// The ranges of bases checked by --verify regressions, each one exercises an edge case that
+//   one of the engines got wrong at some point
+const std::pair<Number_t,Number_t> regression_ranges[] = {
+  {3, 3000},             // the small bases, including short progressions (odd w, t == 0)
+  {2642246, 2642250},    // the first N with N^3 >= 2^64 (sieve), P(2642247) has 3 digits
+};
+
+bool verify_regressions()
+{
+  bool ok = true;
+  for(const auto &range : regression_ranges) {
+    ok = verify_engines(range.first, range.second) && ok;
+  }
+  return ok;
+}
+
+struct SweepState
+{
+  // The state of a sweep (or of one shard of a sweep) as saved to a checkpoint file:
+  //   - the range of bases being swept and the next base to be examined
+  //   - the solution sequence (records) found so far, each with the time it was found
+  //   - the elapsed time
+  // The file is plain text, one "key value(s)" line per item (# starts a comment line)
+  struct Record
+  {
+    Number_t N;
+    Wide_t   pn;
+    time_t   elapsed;  // time (since the start of the sweep) when the record was found
+  };
+
+  Number_t first_N;  // first base of the sweep (3 unless sharded)
+  Number_t end_N;    // the sweep stops before this base
+  Number_t next_N;   // next base to be examined
+  time_t   elapsed;
+  std::vector<Record> records;
+
+  SweepState(Number_t N0=3, Number_t N1=ULLONG_MAX) 
+  : first_N(N0), end_N(N1), next_N(N0), elapsed(0) 
+  {}
+
+  // returns false if the file could not be read
+  bool load(const std::string &path)
+  {
+    std::ifstream in(path.c_str());
+    if(!in) { return false; }
+
+    std::string key;
+    while(in >> key) {
+      if     (key == "first_N") { in >> first_N; }
+      else if(key == "end_N"  ) { in >> end_N;   }
+      else if(key == "next_N" ) { in >> next_N;  }
+      else if(key == "elapsed") { in >> elapsed; }
+      else if(key == "record" ) {
+        Record record;
+        std::string pn;
+        in >> record.N >> pn >> record.elapsed;
+        record.pn = strtowide(pn.c_str(), NULL);
+        records.push_back(record);
+      }
+      else { std::getline(in,key); }  // comment (or something we don't know about)
+    }
+    return !in.bad() && first_N >= 3 && first_N <= next_N;
+  }
+
+  // The file is written to a temporary file which then replaces the checkpoint file
+  //   (rename is atomic), so a crash while writing never loses the prior checkpoint
+  //   returns false if the file could not be written
+  bool save(const std::string &path) const
+  {
+    std::string tmp_path = path + ".tmp";
+    {
+      std::ofstream out(tmp_path.c_str());
+      out << "# sweep checkpoint (see --resume and --merge)" << std::endl
+        << "first_N " << first_N << std::endl
+        << "end_N "   << end_N   << std::endl
+        << "next_N "  << next_N  << std::endl
+        << "elapsed " << elapsed << std::endl;
+      for(auto r = records.begin(); r!=records.end(); ++r) {
+        out << "record " << r->N << " " << wide_str(r->pn) << " " << r->elapsed << std::endl;
+      }
+      if(!out) { return false; }
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+  }
+};
+
+void report_record(const SweepState::Record &record)
+{
+  std::cout 
+    << hh_mm_ss(record.elapsed) << "  "
+    << record.N << ": "
+    << add_commas(record.pn) << ": "
+    << base_n_str(record.pn,record.N) << " "
+    << base_n_str(record.pn,2)
+    << std::endl;
+}
+
+class Sweep
+{
+  // Tracks the solution sequence as P(N) values are examined in increasing order of N.
+  // Only P(N) values that are larger than the last P(N) value in the solution sequence
+  //   are reported (to stdout).
+  // The sweep is complete once a P(N) value reaches the target (or all of the bases in
+  //   its range have been examined)
+  //
+  // If a checkpoint file is specified, the state of the sweep (see SweepState) is 
+  //   periodically saved to it.  The clock is only checked every checkpoint_poll bases, and
+  //   the file is only written once the checkpoint interval (seconds) has passed, so the
+  //   cost is negligible.  A final checkpoint is written once the sweep is complete.
+  // resume loads the state from a checkpoint file, re-reporting the solution sequence so
+  //   far with the original time stamps
+
+private:
+  static const Count_t checkpoint_poll = 1024;
+
+  time_t     _start_time; // used to time stamp each reported P(N)
+  Wide_t     _max_pn;     // largest P(N) found so far (last value in the solution sequence)
+  Wide_t     _tgt_pn;     // sweep is complete once P(N) reaches this value
+  SweepState _state;
+
+  std::string _checkpoint_path;     // empty if not checkpointing
+  time_t      _checkpoint_interval; // seconds between checkpoints
+  time_t      _last_checkpoint;
+  Count_t     _poll_countdown;      // number of bases until the clock is checked again
+
+  PnTableWriter *_table;            // P(N) of every base (NULL if not wanted)
+
+public:
+  Sweep(Wide_t tgt_pn, const std::string &checkpoint_path = "", time_t checkpoint_interval = 10) 
+  : _start_time(std::time(NULL)), _max_pn(0), _tgt_pn(tgt_pn), _state(3,Number_t(std::min<Wide_t>(tgt_pn,ULLONG_MAX))),
+    _checkpoint_path(checkpoint_path), _checkpoint_interval(checkpoint_interval),
+    _last_checkpoint(_start_time), _poll_countdown(checkpoint_poll), _table(NULL)
+  {}
+
+  // Saves P(N) of every base from next_N on to the table (see PnTableWriter)
+  void set_table(PnTableWriter *table) { _table = table; }
+
+  // Limits the sweep to the bases in [N0,N1) (i.e. one shard of the full sweep)
+  //   The solution sequence is then the running maxima local to the shard.
+  void set_range(Number_t N0, Number_t N1) { _state = SweepState(N0,N1); }
+
+  Wide_t   target() const { return _tgt_pn; }
+  Wide_t   max_pn() const { return _max_pn; }
+  Number_t first_N() const { return _state.first_N; }
+  Number_t next_N() const { return _state.next_N; }
+  Number_t end_N()  const { return _state.end_N; }
+
+  // returns true if the sweep is already complete (i.e. a resumed sweep)
+  bool complete() const { return _max_pn >= _tgt_pn || _state.next_N >= _state.end_N; }
+
+  // Examines P(N) for the next N in the sweep
+  //   returns true if the sweep is complete
+  bool update(Number_t N, Wide_t pn)
+  {
+    _state.next_N = N+1;
+    if(_table) { _table->append(N,pn); }
+    if(pn > _max_pn) {
+      SweepState::Record record = { N, pn, std::time(NULL) - _start_time };
+      _state.records.push_back(record);
+      report_record(record);
+      
+      _max_pn = pn;
+    }
+
+    // if P(N) exceeds the target (or we're out of bases), we're done
+    if(complete()) { 
+      if(!_checkpoint_path.empty()) { checkpoint(); }
+      return true; 
+    }
+
+    if(--_poll_countdown == 0) { poll_checkpoint(); }
+    return false;
+  }
+
+  // Loads the state of the sweep from a checkpoint file
+  //   returns false if the file could not be read
+  bool resume(const std::string &path)
+  {
+    if(!_state.load(path)) { return false; }
+
+    // continue the clock from where the checkpointed sweep left off
+    _start_time      = std::time(NULL) - _state.elapsed;
+    _last_checkpoint = std::time(NULL);
+
+    for(auto r = _state.records.begin(); r!=_state.records.end(); ++r) {
+      report_record(*r);
+      _max_pn = std::max(_max_pn, r->pn);
+    }
+    return true;
+  }
+
+  // Writes the current state of the sweep to the checkpoint file
+  void checkpoint()
+  {
+    // (the table must cover all of the bases before the checkpoint's next_N, see PnTableWriter)
+    if(_table) { _table->flush(); }
+    _state.elapsed = std::time(NULL) - _start_time;
+    if(!_state.save(_checkpoint_path)) {
+      std::cerr << "failed to write checkpoint: " << _checkpoint_path << std::endl;
+    }
+    _last_checkpoint = std::time(NULL);
+  }
+
+private:
+  void poll_checkpoint()
+  {
+    _poll_countdown = checkpoint_poll;
+    if(_checkpoint_path.empty()) { return; }
+    if(std::time(NULL) - _last_checkpoint >= _checkpoint_interval) { checkpoint(); }
+  }
+};
+
+class BlockQueue
+{
+  // Shared queue of the bases (N) still to be examined by the worker threads.
+  // Bases are handed out in blocks of consecutive N.  Whichever worker is idle
+  //   takes the next block, so a worker stuck on an expensive base never holds
+  //   up the bases that follow it.
+  // The queue is generated lazily from the next unassigned N rather than
+  //   being populated up front (the upper bound is effectively infinite).
+
+private:
+  std::mutex _mutex;
+  Number_t   _next_N;      // first N of the next block to be handed out
+  Number_t   _end_N;       // no blocks are handed out at or beyond this N
+  Count_t    _block_size;  // number of bases in each block
+  bool       _closed;      // set once the sweep is complete
+
+public:
+  BlockQueue(Number_t N0, Number_t N1, Count_t block_size)
+  : _next_N(N0), _end_N(N1), _block_size(block_size), _closed(false)
+  {}
+
+  // Assigns the next block [N0,N1) to the calling worker
+  //   returns false if there is nothing left to do
+  bool pop(Number_t &N0, Number_t &N1)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_closed || _next_N >= _end_N) { return false; }
+    N0 = _next_N;
+    N1 = (_end_N - N0 > _block_size) ? N0 + _block_size : _end_N;
+    _next_N = N1;
+    return true;
+  }
+
+  // Stops handing out blocks
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _closed = true;
+  }
+};
+
+class HybridScheduler
+{
+  // Cost aware search of the bases of a parallel sweep (see --split)
+  //   Cheap bases are still handed out in blocks (see BlockQueue), but a worker that gets
+  //   stuck on an expensive base no longer holds up the reduction on its own.
+  //
+  // Each base is searched in increasing order of palindrome, one length at a time
+  //   - 2 to 4 digits:   as the progression engine does
+  //   - 5 digits and up: with a PruningOdometer, as the progression engine does
+  //   - lengths that don't fit in 64 bits:  as the wide engine does (serially)
+  // The running cost of the base is checked every chunk_size steps.  Once it exceeds the time
+  //   budget, the rest of each length is split into chunks of rows (see RowOdometer, each row
+  //   searched with search_progression) of about split_size palindromes (a Split) that the
+  //   idle workers take over (steal) along with the worker that owns the base.  The chunks are
+  //   claimed in increasing order and, as the chunks are in increasing order of palindrome,
+  //   nobody needs to claim another chunk once any of them has a hit.  The smallest hit of
+  //   the chunks that were claimed is P(N).
+
+private:
+  static const Number_t chunk_size = 1<<16;
+  static const Number_t split_size = 1<<20;
+
+  typedef std::chrono::steady_clock Clock_t;
+
+  struct Split
+  {
+    // the rows [r0,r1) (see RowOdometer) of length L of base N, in chunks of size rows
+    Number_t N;
+    Count_t  L;
+    Number_t r0, r1;
+    Number_t size;
+    Number_t nchunks;
+
+    std::atomic<Number_t> next_chunk;  // next chunk to be claimed
+    std::atomic<Number_t> hit;         // smallest hit so far (0 if none)
+    unsigned              nbusy;       // number of helpers working on the chunks
+  };
+
+  Clock_t::duration       _budget;
+  std::mutex              _mutex;
+  std::condition_variable _done_cv;   // signals the owners of the splits that a helper is done
+  std::condition_variable _split_cv;  // signals the idle workers that there is a new split
+                                      //   (or that no more splits can come)
+  std::vector<Split*>     _splits;    // the splits that idle workers can help with
+  unsigned                _nblocks;   // number of workers on a block (and so might split a base)
+
+public:
+  HybridScheduler(double budget)
+  : _budget(std::chrono::duration_cast<Clock_t::duration>(std::chrono::duration<double>(budget))), _nblocks(0)
+  {}
+
+  // A worker calls begin_block before it takes a block, and end_block once it is done with it
+  //   (or didn't get one).  Only a worker between the two can split a base.
+  void begin_block()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_nblocks;
+  }
+
+  void end_block()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_nblocks;
+    }
+    _split_cv.notify_all();
+  }
+
+  // Called by a worker that is out of blocks, waits for a split to help with
+  //   returns false once there are none and none of the other workers can split a base
+  bool wait_for_split()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _split_cv.wait(lock, [this]{ return available() || _nblocks == 0; });
+    return available() != NULL;
+  }
+
+  // P(N), split across the idle workers if it takes longer than the budget
+  Wide_t calc_Pn(Number_t N)
+  {
+    Clock_t::time_point deadline = Clock_t::now() + _budget;
+
+    Count_t  L64 = max_length<Number_t>(N);
+    Count_t  L4  = std::min(L64, Count_t(4));
+    Number_t pn  = calc_Pn_lengths(N, progression_length_search, L4);
+    if(pn) { return pn; }
+
+    // p is the first palindrome of length L (checked by calc_Pn_lengths, or the previous length)
+    FastIsBinaryPalindrome is_binary_palindrome;
+    Number_t NL = 1;  // N^(L-1)
+    for(Count_t i=0; i<L4; ++i) { NL *= N; }
+    Number_t p  = NL + 1;
+    bool over_budget = false;
+    for(Count_t L=L4+1; L<=L64; ++L, NL *= N) {
+      RowOdometer rows(N,L);
+      Number_t r = 0;
+      if(!over_budget) {
+        PruningOdometer g(N,L);
+        for(Count_t k=1; g.step(p); ++k) {
+          if(is_binary_palindrome(p)) { return p; }
+          if(k % chunk_size == 0 && Clock_t::now() >= deadline) { 
+            over_budget = true; 
+            break; 
+          }
+        }
+        if(!over_budget) {
+          // (on the first palindrome of the next length)
+          if(is_binary_palindrome(p)) { return p; }
+          continue;
+        }
+        // (the row of p is searched again from its start, its misses don't change the result)
+        r = rows.row_of(p);
+      }
+      // over budget, hand out the rest of the length (and all of the lengths that follow)
+      Number_t hit = split(N, L, r, rows.rows());
+      if(hit) { return hit; }
+      p = NL*N + 1;
+      if(is_binary_palindrome(p)) { return p; }
+    }
+    return search_wide(N, L64);
+  }
+
+  // Works on the chunks of one of the splits (called by the idle workers)
+  //   returns false if there aren't any chunks to work on
+  bool help()
+  {
+    Split *split = NULL;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      split = available();
+      if(split == NULL) { return false; }
+      ++split->nbusy;
+    }
+    run_chunks(*split);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --split->nbusy;
+    }
+    _done_cv.notify_all();
+    return true;
+  }
+
+private:
+  // first split with chunks left to claim (NULL if none), _mutex must be held
+  Split *available() const
+  {
+    for(auto s = _splits.begin(); s!=_splits.end(); ++s) {
+      if((*s)->next_chunk < (*s)->nchunks && (*s)->hit == 0) { return *s; }
+    }
+    return NULL;
+  }
+
+  // searches the rows [r,r+n) of length L (returns the first binary palindrome, or 0)
+  //   (only used for 5 or more digits, which all exceed 2N)
+  static Number_t search_chunk(Number_t N, Count_t L, Number_t r, Number_t n, FastIsBinaryPalindrome &is_binary_palindrome)
+  {
+    RowOdometer g(N,L);
+    Number_t    c;
+    g.seek_row(r,c);
+    for(Number_t i=1; true; ++i) {
+      Number_t p = search_progression(c, g.inner_weight(), N-1, is_binary_palindrome);
+      if(p) { return p; }
+      if(i == n) { return 0; }
+      g.step_row(c);
+    }
+  }
+
+  // searches the rows [r0,r1) of length L, with the help of any idle workers
+  Number_t split(Number_t N, Count_t L, Number_t r0, Number_t r1)
+  {
+    Split split;
+    split.N = N; split.L = L; split.r0 = r0; split.r1 = r1;
+    split.size       = std::max(split_size/N, Number_t(1));
+    split.nchunks    = (r1 - r0 + split.size - 1)/split.size;
+    split.next_chunk = 0;
+    split.hit        = 0;
+    split.nbusy      = 0;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _splits.push_back(&split);
+    }
+    _split_cv.notify_all();
+
+    run_chunks(split);
+
+    // no new helpers once the split is withdrawn, wait for the ones still at work
+    std::unique_lock<std::mutex> lock(_mutex);
+    _splits.erase(std::find(_splits.begin(), _splits.end(), &split));
+    _done_cv.wait(lock, [&]{ return split.nbusy == 0; });
+    return split.hit;
+  }
+
+  static void run_chunks(Split &split)
+  {
+    FastIsBinaryPalindrome is_binary_palindrome;
+    for(Number_t c = split.next_chunk++; c < split.nchunks && split.hit == 0; c = split.next_chunk++) {
+      Number_t r   = split.r0 + c*split.size;
+      Number_t hit = search_chunk(split.N, split.L, r, std::min(split.size, split.r1-r), is_binary_palindrome);
+      if(hit) {
+        // keep the smallest (a chunk claimed earlier may still find a smaller one)
+        Number_t cur = split.hit;
+        while((cur == 0 || hit < cur) && !split.hit.compare_exchange_weak(cur,hit)) {}
+      }
+    }
+  }
+};
+
+class ParallelSweep
+{
+  // Runs the sweep across a pool of worker threads
+  //   - each worker repeatedly pulls a block of bases from the BlockQueue and computes P(N)
+  //     for every N in that block
+  //   - completed blocks go through an ordered reduction that feeds the P(N) values to
+  //     the Sweep in increasing N, exactly as the serial loop in main would.  Blocks that
+  //     complete early are held until all of the blocks before them are done.
+  //   - with a HybridScheduler (--split), the workers search the bases themselves, and an idle
+  //     worker helps with the chunks of any expensive base before it takes a new block
+  // The output is thus identical to the serial run (other than the time stamps).
+
+private:
+  typedef std::vector<Wide_t>             Block_t;
+  typedef std::map<Number_t, Block_t>     PendingBlocks_t;
+
+  Sweep           &_sweep;
+  const Engine    &_engine;   // engine used to compute each P(N)
+  StatsSink       *_stats;    // per-base statistics (NULL if not wanted)
+  HybridScheduler *_hybrid;   // replaces the engine when expensive bases are split (NULL if not)
+  BlockQueue      _queue;
+  unsigned        _nthreads;
+
+  std::mutex      _reduce_mutex;
+  Number_t        _next_N;   // next N to be fed to the sweep
+  PendingBlocks_t _pending;  // completed blocks waiting on earlier blocks (keyed by first N)
+  bool            _done;     // set once the sweep reports that it is complete
+
+public:
+  ParallelSweep(Sweep &sweep, const Engine &engine, unsigned nthreads, Count_t block_size, StatsSink *stats,
+                HybridScheduler *hybrid = NULL)
+  : _sweep(sweep), _engine(engine), _stats(stats), _hybrid(hybrid), _queue(sweep.next_N(),sweep.end_N(),block_size), 
+    _nthreads(nthreads), _next_N(sweep.next_N()), _done(false)
+  {}
+
+  void run()
+  {
+    std::vector<std::thread> workers;
+    for(unsigned i=0; i<_nthreads; ++i) {
+      workers.push_back( std::thread(&ParallelSweep::worker, this) );
+    }
+    for(auto w = workers.begin(); w!=workers.end(); ++w) { w->join(); }
+  }
+
+private:
+  void worker()
+  {
+    Number_t N0, N1;
+    while(true) {
+      // (the chunks of an expensive base hold up the reduction, they go before any new block)
+      if(_hybrid && _hybrid->help()) { continue; }
+      if(_hybrid) { _hybrid->begin_block(); }
+      if(!_queue.pop(N0,N1)) {
+        // out of blocks, but the workers still on a block could yet split one of their bases
+        if(_hybrid) {
+          _hybrid->end_block();
+          if(_hybrid->wait_for_split()) { continue; }
+        }
+        break;
+      }
+
+      Block_t pns(N1-N0);
+      if(_hybrid) {
+        for(Number_t N=N0; N<N1; ++N) {
+          pns[N-N0] = _hybrid->calc_Pn(N);
+          record_progress(N,N+1,&pns[N-N0]);
+        }
+      } else {
+        _engine.calc_range(N0,N1,pns.data(),_stats);
+      }
+      reduce(N0,pns);
+      if(_hybrid) { _hybrid->end_block(); }
+    }
+  }
+
+  void reduce(Number_t N0, Block_t &pns)
+  {
+    std::lock_guard<std::mutex> lock(_reduce_mutex);
+    if(_done) { return; }
+
+    _pending[N0].swap(pns);
+
+    // feed every block that is now contiguous with the bases already examined
+    while( !_pending.empty() && _pending.begin()->first == _next_N ) {
+      Block_t &block = _pending.begin()->second;
+      for(auto pn = block.begin(); pn!=block.end(); ++pn, ++_next_N) {
+        if(_sweep.update(_next_N,*pn)) {
+          // sweep is complete, no need to examine any more bases
+          _done = true;
+          _queue.close();
+          return;
+        }
+      }
+      _pending.erase(_pending.begin());
+    }
+  }
+};
+
+int merge_shards(const std::vector<std::string> &paths, Wide_t tgt_pn)
+{
+  // Rebuilds the solution sequence from the result (checkpoint) files of the shards of a sweep
+  //   Each shard's records are the running maxima local to its range of bases.  Taking the
+  //   shards in order of N, a shard's record is a global record if it exceeds the largest
+  //   P(N) of all of the earlier shards (which is simply the last global record so far).
+  //   returns 0 if the shards cover all of the bases from N=3 until the target was reached
+  std::vector<SweepState> shards(paths.size());
+  for(size_t i=0; i<paths.size(); ++i) {
+    if(!shards[i].load(paths[i])) {
+      std::cerr << "failed to read shard: " << paths[i] << std::endl;
+      return 1;
+    }
+  }
+  std::sort(shards.begin(), shards.end(), 
+    [](const SweepState &a, const SweepState &b) { return a.first_N < b.first_N; });
+
+  Wide_t   max_pn = 0;
+  Number_t next_N = 3;  // first base not covered by the shards so far
+  for(auto shard = shards.begin(); shard!=shards.end(); ++shard) {
+    if(shard->first_N != next_N) {
+      std::cerr << "shards " << (shard->first_N > next_N ? "are missing" : "overlap")
+        << " bases [" << std::min(next_N,shard->first_N) << "," << std::max(next_N,shard->first_N) 
+        << ")" << std::endl;
+      return 1;
+    }
+    for(auto r = shard->records.begin(); r!=shard->records.end(); ++r) {
+      if(r->pn > max_pn) {
+        report_record(*r);
+        max_pn = r->pn;
+        if(max_pn >= tgt_pn) { 
+          std::cout << std::endl;
+          return 0; 
+        }
+      }
+    }
+    next_N = shard->next_N;
+    if(shard->next_N < shard->end_N) {
+      std::cerr << "shard [" << shard->first_N << "," << shard->end_N << ") is incomplete"
+        << " (resume it from N=" << shard->next_N << ")" << std::endl;
+      return 1;
+    }
+  }
+  std::cerr << "target not reached, the shards only cover bases up to " << next_N << std::endl;
+  return 1;
+}
+
+class PnTable
+{
+  // Read only view of a P(N) table file (see PnTableWriter)
+  //   The file is mapped into memory rather than read, so looking up P(N) of any base is a
+  //   single (page cache) access, and only the pages that are actually looked at are read.
+
+private:
+  int                 _fd;
+  void               *_data;     // the mapped file
+  size_t              _size;
+  Number_t            _first_N;
+  Count_t             _count;    // number of entries
+  const PnTableEntry *_entries;
+
+public:
+  PnTable(const std::string &path) 
+  : _fd(open(path.c_str(), O_RDONLY)), _data(MAP_FAILED), _size(0), _first_N(0), _count(0), _entries(NULL)
+  {
+    struct stat st;
+    if(_fd < 0 || fstat(_fd, &st) != 0 || size_t(st.st_size) < sizeof(PnTableHeader)) { return; }
+    _size = st.st_size;
+    _data = mmap(NULL, _size, PROT_READ, MAP_SHARED, _fd, 0);
+    if(_data == MAP_FAILED) { return; }
+
+    const PnTableHeader *header = static_cast<const PnTableHeader *>(_data);
+    if( std::memcmp(header->magic, pn_table_magic, sizeof(header->magic)) != 0 
+        || header->entry_size != sizeof(PnTableEntry) ) { return; }
+    _first_N = header->first_N;
+    _count   = (_size - sizeof(PnTableHeader)) / sizeof(PnTableEntry);
+    _entries = reinterpret_cast<const PnTableEntry *>(header + 1);
+  }
+
+  ~PnTable()
+  {
+    if(_data != MAP_FAILED) { munmap(_data, _size); }
+    if(_fd >= 0) { ::close(_fd); }
+  }
+
+  bool ok() const { return _entries != NULL; }
+
+  // the table covers the bases [first_N,end_N)
+  Number_t first_N() const { return _first_N; }
+  Number_t end_N()   const { return _first_N + _count; }
+
+  Wide_t  pn(Number_t N)     const { const PnTableEntry &e = entry(N); return (Wide_t(e.pn_hi) << 64) | e.pn_lo; }
+  Count_t length(Number_t N) const { return entry(N).L; }
+
+private:
+  const PnTableEntry &entry(Number_t N) const { return _entries[N - _first_N]; }
+};
+
+int query_table(const std::string &path, Number_t N0, Number_t N1)
+{
+  // Answers a query from a P(N) table file (see --query) without computing any P(N)
+  //   N1 == 0:  rebuilds the solution sequence (the running maxima) from all of the bases
+  //             in the table, in the same format as the sweep (without the time stamps)
+  //   N1 > 0:   lists N, P(N) and its number of base-N digits (L) as CSV for every base
+  //             in [N0,N1) that the table covers
+  PnTable table(path);
+  if(!table.ok()) {
+    std::cerr << "failed to read P(N) table: " << path << std::endl;
+    return 1;
+  }
+  if(N1 == 0) {
+    Wide_t max_pn = 0;
+    for(Number_t N=table.first_N(); N<table.end_N(); ++N) {
+      Wide_t pn = table.pn(N);
+      if(pn > max_pn) {
+        std::cout << N << ": " << add_commas(pn) << ": " << base_n_str(pn,N) << " " << base_n_str(pn,2) << std::endl;
+        max_pn = pn;
+      }
+    }
+    return 0;
+  }
+  std::cout << "N,pn,L" << std::endl;
+  for(Number_t N=std::max(N0,table.first_N()); N<std::min(N1,table.end_N()); ++N) {
+    std::cout << N << "," << wide_str(table.pn(N)) << "," << table.length(N) << std::endl;
+  }
+  return 0;
+}
+
+void usage(const char *cmd)
+{
+  std::cerr
+    << "Usage: " << cmd << " [options]" << std::endl
+    << "  -t, --threads <n>     number of worker threads (default: 1, 0=all cores)" << std::endl
+    << "  -b, --block <n>       bases handed to a worker (or range mode engine) at a time (default: 256)" << std::endl
+    << "      --target <P(N)>   stop once P(N) reaches this value (default: 1 quadrillion), values" << std::endl
+    << "                          beyond 64 bits require an engine with 128 bit support (wide)" << std::endl
+    << "  -e, --engine <name>   engine used to compute P(N) (default: wide)" << std::endl
+    << "      --verify <N0:N1>  compare all engines against the reference for N in [N0,N1)" << std::endl
+    << "      --verify regressions  ... for each of the ranges that have turned up engine bugs" << std::endl
+    << "      --checkpoint <f>  periodically save the state of the sweep to file f" << std::endl
+    << "      --checkpoint-interval <s>  seconds between checkpoints (default: 10)" << std::endl
+    << "      --resume <f>      continue the sweep saved in checkpoint file f" << std::endl
+    << "      --range <N0:N1>   only sweep the bases in [N0,N1), writing the running maxima to" << std::endl
+    << "                          the checkpoint file (default: range_<N0>_<N1>.txt)" << std::endl
+    << "      --shard <i/n>     only sweep the ith of n equal parts of the --range" << std::endl
+    << "      --merge <f...>    rebuild the solution sequence from the files of all shards (last option)" << std::endl
+    << "      --stats <f>       write per-base statistics to CSV file f (the tested/passed counts" << std::endl
+    << "                          are only written when compiled with -DPALINDROME_STATS)" << std::endl
+    << "      --progress <s>    report the progress of each thread to stderr every s seconds" << std::endl
+    << "                          (0: only when sent SIGUSR1, not handled without --progress/--status)" << std::endl
+    << "      --status <f>      write the progress reports to file f instead of stderr" << std::endl
+    << "      --table <f>       write P(N) of every base to the binary table file f (not with --bounded)" << std::endl
+    << "      --query <f>       rebuild the solution sequence from the table file f or, with --range," << std::endl
+    << "                          list P(N) (and its length) of the bases in the range" << std::endl
+    << "      --build-index <f> write all binary palindromes of up to --index-bits bits to the index f" << std::endl
+    << "      --index-bits <b>  (default: 50, 2^26 palindromes or 512MB)" << std::endl
+    << "      --index <f>       read the binary palindromes (binary first and sieve engines) from the" << std::endl
+    << "                          index f rather than generating them" << std::endl
+    << "      --split <s>       split any base whose search takes longer than s seconds into chunks" << std::endl
+    << "                          that idle threads take over (ignores --engine and --stats)" << std::endl
+    << "      --bounded         rule out bases (all threads on one base at a time) that cannot" << std::endl
+    << "                          exceed the largest P(N) so far, ignores --engine and --block" << std::endl
+    << "Engines:" << std::endl;
+  for(const Engine *e = engines; e!=engines_end; ++e) {
+    std::cerr << "  " << std::setw(10) << std::left << e->name << "  " << e->description << std::endl;
+  }
+  exit(1);
+}
+
+int main(int argc, const char * argv[])
+{
+  unsigned nthreads   = 1;
+  Count_t  block_size = 256;
+  Wide_t   tgt_pn     = 1000000000000000; // 1 quadrillion
+  const Engine *engine = find_engine("wide");
+  Number_t verify_N0  = 0;
+  Number_t verify_N1  = 0;
+  bool     verify_all = false;
+  bool     bounded    = false;
+  std::string checkpoint_path;
+  std::string resume_path;
+  time_t   checkpoint_interval = 10;
+  Number_t range_N0   = 0;
+  Number_t range_N1   = 0;
+  Number_t shard_i    = 0;
+  Number_t shard_n    = 0;
+  std::vector<std::string> merge_paths;
+  std::string stats_path;
+  bool     progress   = false;
+  time_t   progress_interval = 0;
+  double   split_budget = 0;
+  std::string status_path;
+  std::string table_path;
+  std::string query_path;
+  std::string build_index_path;
+  unsigned    index_bits = 50;
+  std::string index_path;
+
+  for(int i=1; i<argc; ++i) {
+    std::string arg(argv[i]);
+    if( arg == "--bounded" ) { bounded = true; continue; }
+    if( arg == "--merge" ) {
+      // all remaining arguments are shard files
+      merge_paths.assign(argv+i+1, argv+argc);
+      if(merge_paths.empty()) { usage(argv[0]); }
+      break;
+    }
+    if( i+1 == argc ) { usage(argv[0]); }
+    if     ( arg == "-t" || arg == "--threads" ) { nthreads   = std::strtoul(argv[++i],NULL,10);  }
+    else if( arg == "-b" || arg == "--block"   ) { block_size = std::strtoull(argv[++i],NULL,10); }
+    else if( arg == "--target"                 ) { tgt_pn     = strtowide(argv[++i],NULL); }
+    else if( arg == "-e" || arg == "--engine"  ) { 
+      engine = find_engine(argv[++i]);
+      if(engine == NULL) { usage(argv[0]); }
+    }
+    else if( arg == "--verify" && std::string(argv[i+1]) == "regressions" ) {
+      verify_all = true;
+      ++i;
+    }
+    else if( arg == "--verify"                 ) {
+      char *end = NULL;
+      verify_N0 = std::strtoull(argv[++i],&end,10);
+      if(*end != ':') { usage(argv[0]); }
+      verify_N1 = std::strtoull(end+1,NULL,10);
+      if(verify_N0 < 3 || verify_N1 <= verify_N0) { usage(argv[0]); }
+    }
+    else if( arg == "--range"                  ) {
+      char *end = NULL;
+      range_N0 = std::strtoull(argv[++i],&end,10);
+      if(*end != ':') { usage(argv[0]); }
+      range_N1 = std::strtoull(end+1,NULL,10);
+      if(range_N0 < 3 || range_N1 <= range_N0) { usage(argv[0]); }
+    }
+    else if( arg == "--shard"                  ) {
+      char *end = NULL;
+      shard_i = std::strtoull(argv[++i],&end,10);
+      if(*end != '/') { usage(argv[0]); }
+      shard_n = std::strtoull(end+1,NULL,10);
+      if(shard_i >= shard_n) { usage(argv[0]); }
+    }
+    else if( arg == "--checkpoint"             ) { checkpoint_path = argv[++i]; }
+    else if( arg == "--checkpoint-interval"    ) { checkpoint_interval = std::strtoul(argv[++i],NULL,10); }
+    else if( arg == "--resume"                 ) { resume_path = argv[++i]; }
+    else if( arg == "--stats"                  ) { stats_path = argv[++i]; }
+    else if( arg == "--progress"               ) { progress_interval = std::strtoul(argv[++i],NULL,10); progress = true; }
+    else if( arg == "--status"                 ) { status_path = argv[++i]; progress = true; }
+    else if( arg == "--table"                  ) { table_path = argv[++i]; }
+    else if( arg == "--query"                  ) { query_path = argv[++i]; }
+    else if( arg == "--build-index"            ) { build_index_path = argv[++i]; }
+    else if( arg == "--index-bits"             ) { index_bits = std::strtoul(argv[++i],NULL,10); }
+    else if( arg == "--index"                  ) { index_path = argv[++i]; }
+    else if( arg == "--split"                  ) { split_budget = std::strtod(argv[++i],NULL); }
+    else                                         { usage(argv[0]); }
+  }
+  if(shard_n > 0 && range_N1 == 0) { usage(argv[0]); }  // shards are parts of a range
+  if(!query_path.empty()) {
+    return query_table(query_path, range_N0, range_N1);
+  }
+  if(!build_index_path.empty()) {
+    if(index_bits < 1 || index_bits > 64) { usage(argv[0]); }
+    build_binary_palindrome_index(build_index_path, index_bits);
+    return 0;
+  }
+  if(!index_path.empty() && !BinaryPalindromeIndex::load(index_path)) {
+    std::cerr << "failed to read binary palindrome index: " << index_path << std::endl;
+    return 1;
+  }
+  // (the bounded search doesn't compute P(N) of the bases it rules out)
+  if(bounded && !table_path.empty()) { usage(argv[0]); }
+  if(bounded && split_budget > 0)    { usage(argv[0]); }
+  if(shard_n > 0) {
+    Number_t size = (range_N1 - range_N0 + shard_n - 1)/shard_n;
+    range_N1 = std::min(range_N1, range_N0 + (shard_i+1)*size);
+    range_N0 = std::min(range_N1, range_N0 + shard_i*size);
+  }
+  // a resumed sweep continues checkpointing to the same file (unless told otherwise)
+  if(checkpoint_path.empty()) { checkpoint_path = resume_path; }
+  if(checkpoint_path.empty() && range_N1 > 0) {
+    checkpoint_path = "range_" + std::to_string(range_N0) + "_" + std::to_string(range_N1) + ".txt";
+  }
+  if(nthreads == 0)   { nthreads = std::max(1u, std::thread::hardware_concurrency()); }
+  if(block_size == 0) { usage(argv[0]); }
+
+  if(verify_N1 > 0) {
+    return verify_engines(verify_N0,verify_N1) ? 0 : 1;
+  }
+  if(verify_all) {
+    return verify_regressions() ? 0 : 1;
+  }
+  if(!merge_paths.empty()) {
+    return merge_shards(merge_paths, tgt_pn);
+  }
+
+  std::unique_ptr<StatsSink> stats;
+  if(!stats_path.empty()) {
+    stats.reset(new StatsSink(stats_path));
+    if(!stats->ok()) {
+      std::cerr << "failed to open stats file: " << stats_path << std::endl;
+      return 1;
+    }
+  }
+
+  if(progress) { Progress::instance().start(progress_interval, status_path); }
+
+  Sweep sweep(tgt_pn, checkpoint_path, checkpoint_interval);
+  if(range_N1 > 0) { sweep.set_range(range_N0, range_N1); }
+  if(!resume_path.empty()) {
+    if(!sweep.resume(resume_path)) {
+      std::cerr << "failed to resume from checkpoint: " << resume_path << std::endl;
+      return 1;
+    }
+    if(sweep.complete()) { 
+      std::cout << std::endl;
+      return 0; 
+    }
+  }
+
+  std::unique_ptr<PnTableWriter> table;
+  if(!table_path.empty()) {
+    table.reset(new PnTableWriter(table_path, sweep.first_N(), sweep.next_N()));
+    if(!table->ok()) {
+      std::cerr << "failed to open P(N) table: " << table_path << std::endl;
+      return 1;
+    }
+    sweep.set_table(table.get());
+  }
+
+  if(bounded) {
+    // Examine increasing bases (N), using all of the threads on each base in turn. Only the
+    //   bases that can't be ruled out by the bounded search get an exact search.
+    BoundedSearch bounded_search(nthreads);
+    //   (with statistics, pn is the double palindrome that ruled N out, not P(N))
+    for(Number_t N=sweep.next_N(); N<sweep.end_N(); ++N)
+    {
+      StatsSink::Clock_t::time_point t0;
+      if(stats) { t0 = stats->start(); }
+      PERF_SCOPE(calc_Pn);
+      Wide_t pn = bounded_search.search(N, Number_t(std::min<Wide_t>(sweep.max_pn(),ULLONG_MAX)), false);
+      if(pn == 0) {
+        pn = bounded_search.search(N, ULLONG_MAX, true);
+        if(pn == 0) {
+          std::cout << "64bit is insufficient" << std::endl;
+          exit(1);
+        }
+      }
+      if(stats) { stats->record(N,N+1,&pn,t0); }
+      record_progress(N,N+1,&pn);
+      if(sweep.update(N,pn)) { break; }
+    }
+  } else if(split_budget > 0) {
+    // (a single thread still searches its bases in chunks, there's just nobody to hand them to)
+    HybridScheduler hybrid(split_budget);
+    ParallelSweep(sweep,*engine,nthreads,block_size,stats.get(),&hybrid).run();
+  } else if(nthreads == 1) {
+    // Examine increaseing bases (N) util P(N) exceeds the target
+    //   The upper bound in this for loop is purely to avoid an infitinite-loop.
+    //   It is expected that the loop will be exited LONG before hitting this.
+    //   Range mode engines are handed a block of bases at a time.
+    if(engine->calc_Pn_range == NULL) { block_size = 1; }
+    std::vector<Wide_t> pns(block_size);
+    bool done = false;
+    for(Number_t N0=sweep.next_N(); !done && N0<sweep.end_N(); N0+=block_size)
+    {
+      Number_t N1 = std::min(N0+block_size, sweep.end_N());
+      engine->calc_range(N0,N1,pns.data(),stats.get());
+      for(Count_t i=0; !done && i<N1-N0; ++i) {
+        done = sweep.update(N0+i,pns[i]);
       }
     }
+  } else {
+    ParallelSweep(sweep,*engine,nthreads,block_size,stats.get()).run();
   }
+  Progress::instance().stop();
   std::cout << std:: endl;
   return 0;
 }
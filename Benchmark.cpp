@@ -0,0 +1,281 @@
+//
+//  Benchmark.cpp
+//  CompBonus
+//
+//  Compares the palindrome generators and checkers of all of the (compiled) attempts
+//
+
+//-------------------------------------------------------------------------------------------------
+// Design Notes
+//-------------------------------------------------------------------------------------------------
+// - Each attempt is compiled into this file as is, inside a namespace of its own
+//   - their main functions are renamed (and never called)
+//   - all of the standard headers they use are included up front (outside of any namespace)
+//     so that the includes within the attempts are no-ops
+//   - each engine is a function computing P(N) for a given base.  All of the Attempt4 engines
+//     (see Attempt4_Solution.cpp) are picked up from its engine table, so new engines
+//     show up here without any changes to this file.
+//
+// - Correctness check
+//   - each engine reproduces the first rows of the solution sequence (Solution.txt)
+//     before it is timed
+//
+// - Timing
+//   - each engine is run over fixed windows of bases (by default 1,000 bases from N=1,000,
+//     10,000 from N=10,000 and 100,000 from N=100,000)
+//   - the slower engines would take hours to get through the larger windows, so each
+//     (engine,window) is cut off after a time limit, the rates below are based on the
+//     bases that were completed
+//   - P(N)/s:        bases completed per second
+//   - candidates/s:  base-N palindromes per second, where the candidates are those the
+//                    Generator steps through to reach P(N).  This is the same amount of work
+//                    for every engine, so engines that prune candidates get credit for it.
+//   - ns/candidate:  the inverse of candidates/s
+//
+// - Build:  g++ -O2 -std=c++17 -pthread -o benchmark Benchmark.cpp
+//-------------------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <climits>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <cctype>
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <memory.h>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#ifdef PALINDROME_PERF
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+namespace attempt2 {
+#define main attempt2_main
+#include "Attempt2.cpp"
+#undef main
+}
+
+namespace attempt3 {
+#define main attempt3_main
+#include "Attemp3.c"
+#undef main
+}
+
+namespace attempt4 {
+#define main attempt4_main
+#include "Attempt4_Solution.cpp"
+#undef main
+}
+
+typedef uint64_t Number_t;
+typedef uint64_t Count_t;
+
+typedef std::chrono::steady_clock Clock_t;
+
+Number_t calc_Pn_attempt2(Number_t N)
+{
+  attempt2::Base base(N);
+  attempt2::Number_t pn = attempt2::P(base);
+
+  // little-endian base-N digits
+  Number_t rval = 0;
+  for(auto d = pn.rbegin(); d!=pn.rend(); ++d) { rval = N*rval + *d; }
+  return rval;
+}
+
+Number_t calc_Pn_attempt3(Number_t N)
+{
+  // (one context for the whole run, with room for any P(N) that fits in 64 bits)
+  static attempt3::Context_t *ctx = attempt3::create_context(64, 64);
+  ctx->N = N;
+  attempt3::find_pn(ctx);
+
+  // little-endian base-N digits
+  Number_t rval = 0;
+  for(attempt3::Size_t i = ctx->CurNumber.size-1; i>=0; --i) {
+    rval = N*rval + ctx->CurNumber.digits[i];
+  }
+  return rval;
+}
+
+struct BenchEngine
+{
+  std::string name;
+  Number_t  (*calc_Pn)(Number_t N);
+};
+
+std::vector<BenchEngine> bench_engines()
+{
+  std::vector<BenchEngine> rval;
+  rval.push_back( BenchEngine{"attempt2", calc_Pn_attempt2} );
+  rval.push_back( BenchEngine{"attempt3", calc_Pn_attempt3} );
+  for(const attempt4::Engine *e = attempt4::engines; e!=attempt4::engines_end; ++e) {
+    rval.push_back( BenchEngine{std::string("attempt4/") + e->name, e->calc_Pn} );
+  }
+  return rval;
+}
+
+struct Row
+{
+  Number_t N;
+  Number_t pn;
+};
+
+bool load_solution(const std::string &path, Count_t nrows, std::vector<Row> &rows)
+{
+  // reads the first rows of the solution sequence:  "hh:mm:ss  N: P(N): base-N binary"
+  std::ifstream in(path.c_str());
+  std::string line;
+  while(rows.size() < nrows && std::getline(in,line)) {
+    std::stringstream ss(line);
+    std::string t, N, pn;
+    if( !(ss >> t >> N >> pn) || !std::isdigit(N[0]) ) { continue; }  // (header line)
+    pn.erase(std::remove(pn.begin(),pn.end(),','), pn.end());
+    rows.push_back( Row{std::strtoull(N.c_str(),NULL,10), std::strtoull(pn.c_str(),NULL,10)} );
+  }
+  return rows.size() == nrows;
+}
+
+bool check_solution(const BenchEngine &engine, const std::vector<Row> &rows)
+{
+  // sweeps N from 3 until the last of the rows, comparing the running maxima against the rows
+  size_t   i = 0;
+  Number_t max_pn = 0;
+  for(Number_t N=3; i<rows.size(); ++N) {
+    Number_t pn = engine.calc_Pn(N);
+    if(pn > max_pn) {
+      if(rows[i].N != N || rows[i].pn != pn) {
+        std::cout << engine.name << ": expected P(" << rows[i].N << ")=" << rows[i].pn
+          << ", found P(" << N << ")=" << pn << std::endl;
+        return false;
+      }
+      max_pn = pn;
+      ++i;
+    }
+  }
+  return true;
+}
+
+void run_window(const BenchEngine &engine, Number_t N0, Number_t N1, double max_seconds)
+{
+  Count_t candidates = 0;
+  Number_t N = N0;
+  double seconds = 0;
+  for( ; N<N1 && seconds < max_seconds; ++N) {
+    // (only the engine is timed, not the counting of the candidates)
+    Clock_t::time_point t0 = Clock_t::now();
+    Number_t pn = engine.calc_Pn(N);
+    seconds += std::chrono::duration<double>(Clock_t::now() - t0).count();
+
+    Count_t L;
+    candidates += attempt4::generator_candidates(N, pn, L);
+  }
+  Count_t nbases = N - N0;
+
+  std::cout << "  " << std::setw(24) << std::left << engine.name << std::right
+    << std::setw(10) << nbases
+    << std::setw(14) << std::fixed << std::setprecision(1) << nbases/seconds
+    << std::setw(16) << std::setprecision(0) << candidates/seconds
+    << std::setw(14) << std::setprecision(3) << 1e9*seconds/candidates
+    << (N < N1 ? "  (time limit)" : "")
+    << std::endl;
+}
+
+void usage(const char *cmd)
+{
+  std::cerr
+    << "Usage: " << cmd << " [options]" << std::endl
+    << "  -w, --window <N0:n>   time n bases starting at N0 (may be repeated)" << std::endl
+    << "                          (default: 1000:1000 10000:10000 100000:100000)" << std::endl
+    << "  -s, --seconds <s>     time limit for each engine in each window (default: 10)" << std::endl
+    << "  -e, --engine <name>   only run engines whose name contains name (may be repeated)" << std::endl
+    << "      --solution <f>    solution sequence to check against (default: Solution.txt)" << std::endl
+    << "      --rows <n>        number of rows of the solution to check (default: 16)" << std::endl
+    << "Engines:" << std::endl;
+  std::vector<BenchEngine> engines = bench_engines();
+  for(auto e = engines.begin(); e!=engines.end(); ++e) { std::cerr << "  " << e->name << std::endl; }
+  exit(1);
+}
+
+int main(int argc, const char * argv[])
+{
+  std::vector<Row>         windows;  // (N0, number of bases)
+  std::vector<std::string> filters;
+  double      max_seconds   = 10;
+  std::string solution_path = "Solution.txt";
+  Count_t     nrows         = 16;
+
+  for(int i=1; i<argc; ++i) {
+    std::string arg(argv[i]);
+    if( i+1 == argc ) { usage(argv[0]); }
+    if     ( arg == "-w" || arg == "--window"  ) {
+      char *end = NULL;
+      Number_t N0 = std::strtoull(argv[++i],&end,10);
+      if(*end != ':' || N0 < 3) { usage(argv[0]); }
+      windows.push_back( Row{N0, std::strtoull(end+1,NULL,10)} );
+    }
+    else if( arg == "-s" || arg == "--seconds" ) { max_seconds = std::strtod(argv[++i],NULL); }
+    else if( arg == "-e" || arg == "--engine"  ) { filters.push_back(argv[++i]); }
+    else if( arg == "--solution"               ) { solution_path = argv[++i]; }
+    else if( arg == "--rows"                   ) { nrows = std::strtoull(argv[++i],NULL,10); }
+    else                                         { usage(argv[0]); }
+  }
+  if(windows.empty()) {
+    windows.push_back( Row{1000,1000} );
+    windows.push_back( Row{10000,10000} );
+    windows.push_back( Row{100000,100000} );
+  }
+
+  std::vector<BenchEngine> engines;
+  std::vector<BenchEngine> all_engines = bench_engines();
+  for(auto e = all_engines.begin(); e!=all_engines.end(); ++e) {
+    bool keep = filters.empty();
+    for(auto f = filters.begin(); f!=filters.end(); ++f) { keep = keep || e->name.find(*f) != std::string::npos; }
+    if(keep) { engines.push_back(*e); }
+  }
+
+  std::vector<Row> rows;
+  if(!load_solution(solution_path, nrows, rows)) {
+    std::cerr << "failed to read " << nrows << " rows from " << solution_path << std::endl;
+    return 1;
+  }
+  std::cout << "checking engines against the first " << nrows << " rows of " << solution_path << std::endl;
+  bool ok = true;
+  for(auto e = engines.begin(); e!=engines.end(); ++e) { ok = check_solution(*e,rows) && ok; }
+  if(!ok) { return 1; }
+
+  for(auto w = windows.begin(); w!=windows.end(); ++w) {
+    std::cout << std::endl << "window [" << w->N << "," << (w->N + w->pn) << ")" << std::endl
+      << "  " << std::setw(24) << std::left << "engine" << std::right << std::setw(10) << "bases"
+      << std::setw(14) << "P(N)/s" << std::setw(16) << "candidates/s" << std::setw(14) << "ns/candidate"
+      << std::endl;
+    for(auto e = engines.begin(); e!=engines.end(); ++e) {
+      run_window(*e, w->N, w->N + w->pn, max_seconds);
+    }
+  }
+  return 0;
+}